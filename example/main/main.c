@@ -58,119 +58,110 @@ DRAM_ATTR static const uint8_t demo_logo[] = {
     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 };
 
-void draw_bitmap_demo(void) {
+void draw_bitmap_demo(pcd8544_handle_t* lcd) {
     ESP_LOGI(TAG, "Running draw bitmap demo");
-    pcd8544_clear();
-    pcd8544_draw_bitmap(demo_logo);
-    pcd8544_flush();
+    pcd8544_clear(lcd);
+    pcd8544_draw_bitmap(lcd, demo_logo);
+    pcd8544_flush(lcd);
     vTaskDelay(pdMS_TO_TICKS(DEMO_TIME_MS));
 }
 
-void draw_string_demo(void) {
+void draw_string_demo(pcd8544_handle_t* lcd) {
     ESP_LOGI(TAG, "Running string demo");
-    pcd8544_clear();
-    pcd8544_goto_xy(10, 20);
-    pcd8544_puts(PCD8544_FONT_5x7, PCD8544_PIXEL_BLACK, "Demo string");
-    pcd8544_flush();
+    pcd8544_clear(lcd);
+    pcd8544_goto_xy(lcd, 10, 20);
+    pcd8544_puts(lcd, PCD8544_FONT_5x7, PCD8544_PIXEL_BLACK, "Demo string");
+    pcd8544_flush(lcd);
     vTaskDelay(pdMS_TO_TICKS(DEMO_TIME_MS));
 }
 
-void draw_pixel_demo(void) {
+void draw_pixel_demo(pcd8544_handle_t* lcd) {
     ESP_LOGI(TAG, "Running draw pixel demo");
-    pcd8544_clear();
-    pcd8544_puts(PCD8544_FONT_5x7, PCD8544_PIXEL_BLACK, "Demo pixel");
-    pcd8544_draw_pixel(42, 25, PCD8544_PIXEL_BLACK);
-    pcd8544_flush();
+    pcd8544_clear(lcd);
+    pcd8544_puts(lcd, PCD8544_FONT_5x7, PCD8544_PIXEL_BLACK, "Demo pixel");
+    pcd8544_draw_pixel(lcd, 42, 25, PCD8544_PIXEL_BLACK);
+    pcd8544_flush(lcd);
     vTaskDelay(pdMS_TO_TICKS(DEMO_TIME_MS));
 }
 
-void draw_line_demo(void) {
+void draw_line_demo(pcd8544_handle_t* lcd) {
     ESP_LOGI(TAG, "Running draw line demo");
-    pcd8544_clear();
-    pcd8544_puts(PCD8544_FONT_5x7, PCD8544_PIXEL_BLACK, "Demo line");
-    pcd8544_draw_line(22, 15, 62, 35, PCD8544_PIXEL_BLACK);
-    pcd8544_flush();
+    pcd8544_clear(lcd);
+    pcd8544_puts(lcd, PCD8544_FONT_5x7, PCD8544_PIXEL_BLACK, "Demo line");
+    pcd8544_draw_line(lcd, 22, 15, 62, 35, PCD8544_PIXEL_BLACK);
+    pcd8544_flush(lcd);
     vTaskDelay(pdMS_TO_TICKS(DEMO_TIME_MS));
 }
 
-void draw_rectangle_demo(void) {
+void draw_rectangle_demo(pcd8544_handle_t* lcd) {
     ESP_LOGI(TAG, "Running draw rectangle demo");
-    pcd8544_clear();
-    pcd8544_puts(PCD8544_FONT_5x7, PCD8544_PIXEL_BLACK, "Demo rectangle");
-    pcd8544_draw_rectagle(11, 23, 31, 33, PCD8544_PIXEL_BLACK, false);
-    pcd8544_draw_rectagle(53, 23, 73, 33, PCD8544_PIXEL_BLACK, true);
-    pcd8544_flush();
+    pcd8544_clear(lcd);
+    pcd8544_puts(lcd, PCD8544_FONT_5x7, PCD8544_PIXEL_BLACK, "Demo rectangle");
+    pcd8544_draw_rectagle(lcd, 11, 23, 31, 33, PCD8544_PIXEL_BLACK, false);
+    pcd8544_draw_rectagle(lcd, 53, 23, 73, 33, PCD8544_PIXEL_BLACK, true);
+    pcd8544_flush(lcd);
     vTaskDelay(pdMS_TO_TICKS(DEMO_TIME_MS));
 }
 
-void draw_circle_demo(void) {
+void draw_circle_demo(pcd8544_handle_t* lcd) {
     ESP_LOGI(TAG, "Running draw circle demo");
-    pcd8544_clear();
-    pcd8544_puts(PCD8544_FONT_5x7, PCD8544_PIXEL_BLACK, "Demo circle");
-    pcd8544_draw_circle(21, 28, 10, PCD8544_PIXEL_BLACK, false);
-    pcd8544_draw_circle(63, 28, 10, PCD8544_PIXEL_BLACK, true);
-    pcd8544_flush();
+    pcd8544_clear(lcd);
+    pcd8544_puts(lcd, PCD8544_FONT_5x7, PCD8544_PIXEL_BLACK, "Demo circle");
+    pcd8544_draw_circle(lcd, 21, 28, 10, PCD8544_PIXEL_BLACK, false);
+    pcd8544_draw_circle(lcd, 63, 28, 10, PCD8544_PIXEL_BLACK, true);
+    pcd8544_flush(lcd);
     vTaskDelay(pdMS_TO_TICKS(DEMO_TIME_MS));
 }
 
-void invert_color_demo(void) {
+void invert_color_demo(pcd8544_handle_t* lcd) {
     ESP_LOGI(TAG, "Running invert color demo");
-    pcd8544_clear();
-    pcd8544_goto_xy(10, 20);
-    pcd8544_puts(PCD8544_FONT_5x7, PCD8544_PIXEL_BLACK, "Demo invert");
-    pcd8544_flush();
+    pcd8544_clear(lcd);
+    pcd8544_goto_xy(lcd, 10, 20);
+    pcd8544_puts(lcd, PCD8544_FONT_5x7, PCD8544_PIXEL_BLACK, "Demo invert");
+    pcd8544_flush(lcd);
 
     for (uint8_t i = 0; i < 8; i++) {
-        pcd8544_invert(i % 2);
+        pcd8544_invert(lcd, i % 2);
         vTaskDelay(pdMS_TO_TICKS(DEMO_TIME_MS / 4));
     }
 
-    pcd8544_invert(false);
+    pcd8544_invert(lcd, false);
 }
 
-void scroll_demo(void) {
+void scroll_demo(pcd8544_handle_t* lcd) {
     ESP_LOGI(TAG, "Running scroll demo");
-    pcd8544_clear();
-    pcd8544_goto_xy(5, 15);
-    pcd8544_puts(PCD8544_FONT_5x7, PCD8544_PIXEL_BLACK, "Demo scroll");
-    pcd8544_flush();
-
-    for (uint8_t i = 0; i < 10; i++) {
-        pcd8544_scroll(1, 0);
-        vTaskDelay(pdMS_TO_TICKS(DEMO_TIME_MS / 40));
-    }
-
-    for (uint8_t i = 0; i < 10; i++) {
-        pcd8544_scroll(0, 1);
-        vTaskDelay(pdMS_TO_TICKS(DEMO_TIME_MS / 40));
-    }
-
-    for (uint8_t i = 0; i < 10; i++) {
-        pcd8544_scroll(-1, 0);
-        vTaskDelay(pdMS_TO_TICKS(DEMO_TIME_MS / 40));
-    }
-
-    for (uint8_t i = 0; i < 10; i++) {
-        pcd8544_scroll(0, -1);
-        vTaskDelay(pdMS_TO_TICKS(DEMO_TIME_MS / 40));
+    pcd8544_clear(lcd);
+    pcd8544_goto_xy(lcd, 5, 15);
+    pcd8544_puts(lcd, PCD8544_FONT_5x7, PCD8544_PIXEL_BLACK, "Demo scroll");
+    pcd8544_flush(lcd);
+
+    // Each scroll runs in the background, wait for it before the next one
+    const int8_t offsets[][2] = {{10, 0}, {0, 10}, {-10, 0}, {0, -10}};
+    for (uint8_t i = 0; i < 4; i++) {
+        pcd8544_scroll_smooth(lcd, offsets[i][0], offsets[i][1],
+                              DEMO_TIME_MS / 4);
+        pcd8544_scroll_smooth_wait(lcd, portMAX_DELAY);
     }
 }
 
 static void lcd_func_demo(void* arg) {
-    pcd8544_set_backlight_fade(100, 2000, true);
-
-    draw_bitmap_demo();
-    draw_string_demo();
-    draw_pixel_demo();
-    draw_line_demo();
-    draw_rectangle_demo();
-    draw_circle_demo();
-    invert_color_demo();
-    scroll_demo();
-
-    pcd8544_clear();
-    pcd8544_set_backlight_fade(0, 2000, true);
-    pcd8544_deinit();
+    pcd8544_handle_t* lcd = arg;
+
+    pcd8544_set_backlight_fade(lcd, 100, 2000, true);
+
+    draw_bitmap_demo(lcd);
+    draw_string_demo(lcd);
+    draw_pixel_demo(lcd);
+    draw_line_demo(lcd);
+    draw_rectangle_demo(lcd);
+    draw_circle_demo(lcd);
+    invert_color_demo(lcd);
+    scroll_demo(lcd);
+
+    pcd8544_clear(lcd);
+    pcd8544_flush(lcd);
+    pcd8544_set_backlight_fade(lcd, 0, 2000, true);
+    pcd8544_deinit(lcd);
     vTaskDelete(NULL);
 }
 
@@ -196,8 +187,9 @@ void app_main(void) {
         .bkl_gpio_num = CONFIG_BKL_PIN_NUM,
     };
 
-    pcd8544_init(CONFIG_LCD_HOST, &lcd_io_cfg);
+    pcd8544_handle_t* lcd;
+    ESP_ERROR_CHECK(pcd8544_init(CONFIG_LCD_HOST, &lcd_io_cfg, &lcd));
 
     /* Create a task to demonstrate some LCD's basic functions */
-    xTaskCreate(lcd_func_demo, "LCD demo", 4 * 1024, NULL, 10, NULL);
+    xTaskCreate(lcd_func_demo, "LCD demo", 4 * 1024, lcd, 10, NULL);
 }
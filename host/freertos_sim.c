@@ -0,0 +1,330 @@
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+// Minimal POSIX stand-ins for the FreeRTOS primitives used by the driver.
+// One tick is one millisecond.
+
+struct tskTaskControlBlock {
+    pthread_t       thread;
+    TaskFunction_t  code;
+    void*           arg;
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+    uint32_t        notify;
+};
+
+typedef enum {
+    SEM_BINARY,
+    SEM_MUTEX,
+    SEM_RECURSIVE,
+} sem_kind_t;
+
+struct QueueDefinition {
+    sem_kind_t      kind;
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+    unsigned        count;
+    pthread_t       owner;
+    bool            owned;
+};
+
+struct EventGroupDef_t {
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+    EventBits_t     bits;
+};
+
+static pthread_key_t  s_task_key;
+static pthread_once_t s_task_key_once = PTHREAD_ONCE_INIT;
+
+// Runs when the thread of a task exits, like the idle task cleaning up after
+// a deleted task
+static void task_free(void* arg) {
+    TaskHandle_t task = arg;
+    pthread_mutex_destroy(&task->lock);
+    pthread_cond_destroy(&task->cond);
+    free(task);
+}
+
+static void task_key_init(void) { pthread_key_create(&s_task_key, task_free); }
+
+static struct timespec deadline_after(TickType_t ticks) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += ticks / 1000;
+    ts.tv_nsec += (long)(ticks % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    return ts;
+}
+
+// Wait on cond until pred() holds; returns false on timeout
+#define WAIT_UNTIL(cond_var, mutex, ticks, pred)                           \
+    ({                                                                     \
+        bool            ok_ = true;                                        \
+        struct timespec ts_ = deadline_after(ticks);                       \
+        while (!(pred)) {                                                  \
+            if ((ticks) == 0) {                                            \
+                ok_ = false;                                               \
+                break;                                                     \
+            }                                                              \
+            if ((ticks) == portMAX_DELAY) {                                \
+                pthread_cond_wait(cond_var, mutex);                        \
+            } else if (pthread_cond_timedwait(cond_var, mutex, &ts_) ==    \
+                       ETIMEDOUT) {                                        \
+                ok_ = (pred);                                              \
+                break;                                                     \
+            }                                                              \
+        }                                                                  \
+        ok_;                                                               \
+    })
+
+int64_t esp_timer_get_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+TickType_t xTaskGetTickCount(void) {
+    return (TickType_t)(esp_timer_get_time() / 1000);
+}
+
+void vTaskDelay(TickType_t ticks) {
+    struct timespec ts = {
+        .tv_sec  = ticks / 1000,
+        .tv_nsec = (long)(ticks % 1000) * 1000000L,
+    };
+    while (nanosleep(&ts, &ts) == -1 && errno == EINTR) {
+    }
+}
+
+void vTaskDelayUntil(TickType_t* previous_wake_time,
+                     TickType_t  time_increment) {
+    *previous_wake_time += time_increment;
+    TickType_t now = xTaskGetTickCount();
+    if ((int32_t)(*previous_wake_time - now) > 0)
+        vTaskDelay(*previous_wake_time - now);
+}
+
+static void* task_entry(void* arg) {
+    TaskHandle_t task = arg;
+    pthread_setspecific(s_task_key, task);
+    task->code(task->arg);
+    return NULL;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t task_code, const char* name,
+                       uint32_t stack_depth, void* parameters,
+                       UBaseType_t priority, TaskHandle_t* created_task) {
+    (void)name;
+    (void)stack_depth;
+    (void)priority;
+    pthread_once(&s_task_key_once, task_key_init);
+
+    TaskHandle_t task = calloc(1, sizeof(struct tskTaskControlBlock));
+    if (!task) return pdFAIL;
+    task->code = task_code;
+    task->arg  = parameters;
+    pthread_mutex_init(&task->lock, NULL);
+    pthread_cond_init(&task->cond, NULL);
+
+    // The task may run and delete itself before pthread_create() returns, so
+    // it must not be touched afterwards
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    if (created_task) *created_task = task;
+    int ret = pthread_create(&task->thread, &attr, task_entry, task);
+    pthread_attr_destroy(&attr);
+
+    if (ret != 0) {
+        if (created_task) *created_task = NULL;
+        free(task);
+        return pdFAIL;
+    }
+    return pdPASS;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    pthread_once(&s_task_key_once, task_key_init);
+    return pthread_getspecific(s_task_key);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    // Only self-deletion is supported, which is all the driver does
+    if (task == NULL || task == xTaskGetCurrentTaskHandle()) pthread_exit(NULL);
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    pthread_mutex_lock(&task->lock);
+    task->notify++;
+    pthread_cond_broadcast(&task->cond);
+    pthread_mutex_unlock(&task->lock);
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks) {
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    if (!task) return 0;
+
+    pthread_mutex_lock(&task->lock);
+    WAIT_UNTIL(&task->cond, &task->lock, ticks, task->notify != 0);
+    uint32_t value = task->notify;
+    if (value) task->notify = clear_on_exit ? 0 : value - 1;
+    pthread_mutex_unlock(&task->lock);
+    return value;
+}
+
+static SemaphoreHandle_t sem_create(sem_kind_t kind, unsigned count) {
+    SemaphoreHandle_t sem = calloc(1, sizeof(struct QueueDefinition));
+    if (!sem) return NULL;
+    sem->kind  = kind;
+    sem->count = count;
+    pthread_mutex_init(&sem->lock, NULL);
+    pthread_cond_init(&sem->cond, NULL);
+    return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+    return sem_create(SEM_MUTEX, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex(void) {
+    return sem_create(SEM_RECURSIVE, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void) {
+    return sem_create(SEM_BINARY, 0);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem) {
+    if (!sem) return;
+    pthread_mutex_destroy(&sem->lock);
+    pthread_cond_destroy(&sem->cond);
+    free(sem);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks) {
+    pthread_mutex_lock(&sem->lock);
+    bool ok = WAIT_UNTIL(&sem->cond, &sem->lock, ticks, sem->count > 0);
+    if (ok) sem->count--;
+    pthread_mutex_unlock(&sem->lock);
+    return ok ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+    pthread_mutex_lock(&sem->lock);
+    bool ok = sem->count == 0;
+    if (ok) {
+        sem->count = 1;
+        pthread_cond_broadcast(&sem->cond);
+    }
+    pthread_mutex_unlock(&sem->lock);
+    return ok ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem,
+                                 BaseType_t*       higher_prio_woken) {
+    if (higher_prio_woken) *higher_prio_woken = pdFALSE;
+    return xSemaphoreGive(sem);
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t sem, TickType_t ticks) {
+    pthread_t self = pthread_self();
+    pthread_mutex_lock(&sem->lock);
+    bool ok = WAIT_UNTIL(&sem->cond, &sem->lock, ticks,
+                         !sem->owned || pthread_equal(sem->owner, self));
+    if (ok) {
+        sem->owned = true;
+        sem->owner = self;
+        sem->count++;
+    }
+    pthread_mutex_unlock(&sem->lock);
+    return ok ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t sem) {
+    pthread_mutex_lock(&sem->lock);
+    bool ok = sem->owned && pthread_equal(sem->owner, pthread_self());
+    if (ok && --sem->count == 0) {
+        sem->owned = false;
+        pthread_cond_broadcast(&sem->cond);
+    }
+    pthread_mutex_unlock(&sem->lock);
+    return ok ? pdTRUE : pdFALSE;
+}
+
+EventGroupHandle_t xEventGroupCreate(void) {
+    EventGroupHandle_t group = calloc(1, sizeof(struct EventGroupDef_t));
+    if (!group) return NULL;
+    pthread_mutex_init(&group->lock, NULL);
+    pthread_cond_init(&group->cond, NULL);
+    return group;
+}
+
+void vEventGroupDelete(EventGroupHandle_t group) {
+    if (!group) return;
+    pthread_mutex_destroy(&group->lock);
+    pthread_cond_destroy(&group->cond);
+    free(group);
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits) {
+    pthread_mutex_lock(&group->lock);
+    group->bits |= bits;
+    EventBits_t ret = group->bits;
+    pthread_cond_broadcast(&group->cond);
+    pthread_mutex_unlock(&group->lock);
+    return ret;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits) {
+    pthread_mutex_lock(&group->lock);
+    EventBits_t ret = group->bits;
+    group->bits &= ~bits;
+    pthread_mutex_unlock(&group->lock);
+    return ret;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group) {
+    pthread_mutex_lock(&group->lock);
+    EventBits_t ret = group->bits;
+    pthread_mutex_unlock(&group->lock);
+    return ret;
+}
+
+BaseType_t xEventGroupSetBitsFromISR(EventGroupHandle_t group,
+                                     EventBits_t        bits,
+                                     BaseType_t*        higher_prio_woken) {
+    if (higher_prio_woken) *higher_prio_woken = pdFALSE;
+    xEventGroupSetBits(group, bits);
+    return pdPASS;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group,
+                                EventBits_t        bits_to_wait_for,
+                                BaseType_t         clear_on_exit,
+                                BaseType_t         wait_for_all_bits,
+                                TickType_t         ticks_to_wait) {
+    pthread_mutex_lock(&group->lock);
+    bool ok = WAIT_UNTIL(
+        &group->cond, &group->lock, ticks_to_wait,
+        wait_for_all_bits
+            ? (group->bits & bits_to_wait_for) == bits_to_wait_for
+            : (group->bits & bits_to_wait_for) != 0);
+    EventBits_t ret = group->bits;
+    if (ok && clear_on_exit) group->bits &= ~bits_to_wait_for;
+    pthread_mutex_unlock(&group->lock);
+    return ret;
+}
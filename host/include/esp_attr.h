@@ -0,0 +1,7 @@
+#ifndef __ESP_ATTR_H__
+#define __ESP_ATTR_H__
+
+#define DRAM_ATTR
+#define IRAM_ATTR
+
+#endif /* __ESP_ATTR_H__ */
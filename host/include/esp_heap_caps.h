@@ -0,0 +1,13 @@
+#ifndef __ESP_HEAP_CAPS_H__
+#define __ESP_HEAP_CAPS_H__
+
+#include <stdlib.h>
+
+#define MALLOC_CAP_DMA     (1 << 3)
+#define MALLOC_CAP_8BIT    (1 << 2)
+#define MALLOC_CAP_DEFAULT (1 << 12)
+
+#define heap_caps_malloc(size, caps)    malloc(size)
+#define heap_caps_calloc(n, size, caps) calloc(n, size)
+
+#endif /* __ESP_HEAP_CAPS_H__ */
@@ -0,0 +1,23 @@
+#ifndef __FREERTOS_EVENT_GROUPS_H__
+#define __FREERTOS_EVENT_GROUPS_H__
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct EventGroupDef_t* EventGroupHandle_t;
+typedef TickType_t              EventBits_t;
+
+EventGroupHandle_t xEventGroupCreate(void);
+void               vEventGroupDelete(EventGroupHandle_t group);
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits);
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits);
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group);
+BaseType_t  xEventGroupSetBitsFromISR(EventGroupHandle_t group,
+                                      EventBits_t        bits,
+                                      BaseType_t*        higher_prio_woken);
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group,
+                                EventBits_t bits_to_wait_for,
+                                BaseType_t clear_on_exit,
+                                BaseType_t wait_for_all_bits,
+                                TickType_t ticks_to_wait);
+
+#endif /* __FREERTOS_EVENT_GROUPS_H__ */
@@ -0,0 +1,21 @@
+#ifndef __FREERTOS_TASK_H__
+#define __FREERTOS_TASK_H__
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct tskTaskControlBlock* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+BaseType_t xTaskCreate(TaskFunction_t task_code, const char* name,
+                       uint32_t stack_depth, void* parameters,
+                       UBaseType_t priority, TaskHandle_t* created_task);
+void       vTaskDelete(TaskHandle_t task);
+void       vTaskDelay(TickType_t ticks);
+void       vTaskDelayUntil(TickType_t* previous_wake_time,
+                           TickType_t  time_increment);
+TickType_t xTaskGetTickCount(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+uint32_t   ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks);
+
+#endif /* __FREERTOS_TASK_H__ */
@@ -0,0 +1,75 @@
+#ifndef __PCD8544_SIM_H__
+#define __PCD8544_SIM_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PCD8544_SIM_COLS  84
+#define PCD8544_SIM_BANKS 6
+
+typedef struct {
+    uint32_t transactions; /*!< SPI transactions addressed to the panel */
+    uint32_t cmd_bytes;    /*!< Bytes clocked in with D/C low */
+    uint32_t data_bytes;   /*!< Bytes clocked in with D/C high */
+} pcd8544_sim_stats_t;
+
+typedef struct {
+    uint8_t ram[PCD8544_SIM_BANKS * PCD8544_SIM_COLS]; /*!< Display RAM */
+    uint8_t x;               /*!< X address counter (0 ~ 83) */
+    uint8_t y;               /*!< Y address counter (bank, 0 ~ 5) */
+    bool    extended;        /*!< H bit: extended instruction set */
+    bool    vertical;        /*!< V bit: vertical addressing */
+    bool    power_down;      /*!< PD bit */
+    uint8_t display_control; /*!< D/E bits of the display control command */
+    uint8_t vop;             /*!< Operating voltage (contrast) */
+    uint8_t bias;            /*!< Bias system */
+    uint8_t temp;            /*!< Temperature coefficient */
+} pcd8544_sim_panel_t;
+
+/**
+ * @brief Get the controller model attached to a CE line.
+ *
+ * @param[in] ce_gpio_num CE gpio the panel was registered with.
+ *
+ * @return Pointer to the panel model, NULL if no device uses that CE line.
+ */
+const pcd8544_sim_panel_t* pcd8544_sim_panel(int ce_gpio_num);
+
+/**
+ * @brief Read one pixel from the controller RAM model.
+ */
+bool pcd8544_sim_get_pixel(int ce_gpio_num, uint8_t x, uint8_t y);
+
+/**
+ * @brief Get the bus statistics of a panel since the last reset.
+ */
+void pcd8544_sim_get_stats(int ce_gpio_num, pcd8544_sim_stats_t* stats);
+
+/**
+ * @brief Reset the bus statistics of a panel.
+ */
+void pcd8544_sim_reset_stats(int ce_gpio_num);
+
+/**
+ * @brief Make transactions to a panel fail, to test error handling.
+ *
+ * After skip more transactions went through, the next count ones fail with
+ * ESP_FAIL and nothing of them reaches the panel.
+ */
+void pcd8544_sim_fail(int ce_gpio_num, uint32_t skip, uint32_t count);
+
+/**
+ * @brief Print the panel content as 48 lines of ASCII art.
+ */
+void pcd8544_sim_dump(int ce_gpio_num, FILE* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PCD8544_SIM_H__ */
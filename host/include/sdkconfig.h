@@ -0,0 +1,13 @@
+#ifndef __SDKCONFIG_H__
+#define __SDKCONFIG_H__
+
+// Host build defaults, mirroring the Kconfig defaults of the component
+
+#define CONFIG_PCD8544_LCD_BIAS             3
+#define CONFIG_PCD8544_LCD_TEMP             2
+#define CONFIG_PCD8544_LCD_CONTRAST         70
+#define CONFIG_PCD8544_RENDER_FPS           30
+#define CONFIG_PCD8544_TRANS_OVERHEAD_BYTES 8
+#define CONFIG_PCD8544_FORMAT_FLOAT         1
+
+#endif /* __SDKCONFIG_H__ */
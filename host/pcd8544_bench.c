@@ -0,0 +1,234 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "esp_timer.h"
+#include "pcd8544.h"
+
+// Timing of the drawing primitives and bus cost of a few typical scenes, run
+// against the simulated controller. Only the relative numbers matter: compare
+// them between two builds of the driver on the same machine.
+
+#define BENCH_CE_GPIO      18
+#define BENCH_SCENE_FRAMES 200
+
+typedef void (*bench_op_t)(pcd8544_handle_t* lcd, uint32_t i);
+typedef void (*bench_scene_t)(pcd8544_handle_t* lcd, uint32_t frame);
+
+static uint8_t s_splash[PCD8544_BUFFER_SIZE];
+static uint8_t s_icon[32];
+static uint8_t s_icon_mask[32];
+
+static void op_pixel(pcd8544_handle_t* lcd, uint32_t i) {
+    pcd8544_draw_pixel(lcd, i % PCD8544_H_RES_MAX, i % PCD8544_V_RES_MAX,
+                       PCD8544_PIXEL_BLACK);
+}
+
+static void op_line(pcd8544_handle_t* lcd, uint32_t i) {
+    pcd8544_draw_line(lcd, 0, i % PCD8544_V_RES_MAX, PCD8544_H_RES_MAX - 1,
+                      (i * 7) % PCD8544_V_RES_MAX, PCD8544_PIXEL_BLACK);
+}
+
+static void op_hline(pcd8544_handle_t* lcd, uint32_t i) {
+    pcd8544_draw_line(lcd, 0, i % PCD8544_V_RES_MAX, PCD8544_H_RES_MAX - 1,
+                      i % PCD8544_V_RES_MAX, PCD8544_PIXEL_BLACK);
+}
+
+static void op_rect(pcd8544_handle_t* lcd, uint32_t i) {
+    pcd8544_draw_rectagle(lcd, i % 20, i % 10, 60 + i % 20, 30 + i % 10,
+                          PCD8544_PIXEL_BLACK, false);
+}
+
+static void op_rect_filled(pcd8544_handle_t* lcd, uint32_t i) {
+    pcd8544_draw_rectagle(lcd, i % 20, i % 10, 60 + i % 20, 30 + i % 10,
+                          i % 2 ? PCD8544_PIXEL_BLACK : PCD8544_PIXEL_WHITE,
+                          true);
+}
+
+static void op_circle(pcd8544_handle_t* lcd, uint32_t i) {
+    pcd8544_draw_circle(lcd, 42, 24, 5 + i % 18, PCD8544_PIXEL_BLACK, false);
+}
+
+static void op_circle_filled(pcd8544_handle_t* lcd, uint32_t i) {
+    pcd8544_draw_circle(lcd, 42, 24, 5 + i % 18, PCD8544_PIXEL_BLACK, true);
+}
+
+static void op_blit(pcd8544_handle_t* lcd, uint32_t i) {
+    // A 16 x 16 icon at every pixel offset, through its mask
+    pcd8544_blit(lcd, i % 80 - 8, i % 44 - 8, 16, 16, s_icon, s_icon_mask);
+}
+
+static void op_blit_xor(pcd8544_handle_t* lcd, uint32_t i) {
+    // A cursor toggled in place, no saving and restoring of what is below
+    pcd8544_blit_color(lcd, i % 80 - 8, i % 44 - 8, 16, 16, s_icon, NULL,
+                       PCD8544_PIXEL_XOR);
+}
+
+static void op_putc(pcd8544_handle_t* lcd, uint32_t i) {
+    if (i % 14 == 0) pcd8544_goto_xy(lcd, 0, (i / 14) % 6 * 8);
+    pcd8544_putc(lcd, PCD8544_FONT_5x7, PCD8544_PIXEL_BLACK, 'A' + i % 26);
+}
+
+static void op_puts(pcd8544_handle_t* lcd, uint32_t i) {
+    pcd8544_goto_xy(lcd, 0, i % 6 * 8);
+    pcd8544_puts(lcd, PCD8544_FONT_5x7, PCD8544_PIXEL_BLACK, "T=%3u.%u C",
+                 (unsigned)(i % 100), (unsigned)(i % 10));
+}
+
+static void op_puts_big(pcd8544_handle_t* lcd, uint32_t i) {
+    // Glyph columns span three banks
+    pcd8544_goto_xy(lcd, 0, i % 3 * 12);
+    pcd8544_puts_font(lcd, &pcd8544_font_12x24_digits, PCD8544_PIXEL_BLACK,
+                      "%02u:%02u", (unsigned)(i / 60 % 24), (unsigned)(i % 60));
+}
+
+static void op_put_fixed(pcd8544_handle_t* lcd, uint32_t i) {
+    // The numeric field of op_puts without a format string
+    pcd8544_goto_xy(lcd, 12, i % 6 * 8);
+    pcd8544_put_fixed(lcd, &pcd8544_font_5x7, PCD8544_PIXEL_BLACK,
+                      (int32_t)(i % 1000), 1, 5, ' ');
+}
+
+static void op_scroll(pcd8544_handle_t* lcd, uint32_t i) {
+    pcd8544_scroll(lcd, i % 2 ? 1 : -1, 0);
+}
+
+static void op_flush(pcd8544_handle_t* lcd, uint32_t i) {
+    pcd8544_draw_pixel(lcd, i % PCD8544_H_RES_MAX, i % PCD8544_V_RES_MAX,
+                       i % 2 ? PCD8544_PIXEL_BLACK : PCD8544_PIXEL_WHITE);
+    pcd8544_flush(lcd);
+}
+
+static void bench_op(pcd8544_handle_t* lcd, const char* name, bench_op_t op,
+                     uint32_t iterations) {
+    pcd8544_clear(lcd);
+    pcd8544_flush(lcd);
+
+    int64_t start = esp_timer_get_time();
+    for (uint32_t i = 0; i < iterations; i++) op(lcd, i);
+    int64_t elapsed = esp_timer_get_time() - start;
+
+    printf("%-20s %10.1f ns/op\n", name, elapsed * 1000.0 / iterations);
+}
+
+static void scene_clear(pcd8544_handle_t* lcd, uint32_t frame) {
+    // Alternate between blank and full so every frame changes every byte
+    pcd8544_clear(lcd);
+    if (frame % 2)
+        pcd8544_draw_rectagle(lcd, 0, 0, PCD8544_H_RES_MAX - 1,
+                              PCD8544_V_RES_MAX - 1, PCD8544_PIXEL_BLACK,
+                              true);
+}
+
+static void scene_dashboard(pcd8544_handle_t* lcd, uint32_t frame) {
+    pcd8544_clear(lcd);
+    pcd8544_goto_xy(lcd, 0, 0);
+    pcd8544_puts(lcd, PCD8544_FONT_5x7, PCD8544_PIXEL_BLACK, "Dashboard");
+    pcd8544_draw_line(lcd, 0, 9, PCD8544_H_RES_MAX - 1, 9,
+                      PCD8544_PIXEL_BLACK);
+    pcd8544_goto_xy(lcd, 0, 12);
+    pcd8544_puts(lcd, PCD8544_FONT_5x7, PCD8544_PIXEL_BLACK, "Temp %2u.%u C",
+                 (unsigned)(20 + frame / 10 % 10), (unsigned)(frame % 10));
+    pcd8544_goto_xy(lcd, 0, 21);
+    pcd8544_puts(lcd, PCD8544_FONT_5x7, PCD8544_PIXEL_BLACK, "Hum  %2u %%",
+                 (unsigned)(40 + frame / 25 % 10));
+    pcd8544_goto_xy(lcd, 0, 30);
+    pcd8544_puts(lcd, PCD8544_FONT_3x5, PCD8544_PIXEL_BLACK, "UPTIME %05u",
+                 (unsigned)frame);
+    pcd8544_draw_rectagle(lcd, 0, 40, PCD8544_H_RES_MAX - 1, 47,
+                          PCD8544_PIXEL_BLACK, false);
+    pcd8544_draw_rectagle(lcd, 2, 42, 2 + frame % 80, 45, PCD8544_PIXEL_BLACK,
+                          true);
+}
+
+static void scene_graph(pcd8544_handle_t* lcd, uint32_t frame) {
+    // One new sample per frame, the rest of the plot moves left
+    static const uint8_t wave[16] = {24, 29, 33, 36, 37, 36, 33, 29,
+                                     24, 19, 15, 12, 11, 12, 15, 19};
+
+    if (frame == 0) {
+        pcd8544_clear(lcd);
+        pcd8544_goto_xy(lcd, 0, 0);
+        pcd8544_puts(lcd, PCD8544_FONT_3x5, PCD8544_PIXEL_BLACK, "LOAD");
+    }
+
+    pcd8544_scroll(lcd, -1, 0);
+    pcd8544_draw_line(lcd, PCD8544_H_RES_MAX - 1, 8, PCD8544_H_RES_MAX - 1,
+                      PCD8544_V_RES_MAX - 1, PCD8544_PIXEL_WHITE);
+    pcd8544_draw_pixel(lcd, PCD8544_H_RES_MAX - 1, wave[frame % 16],
+                       PCD8544_PIXEL_BLACK);
+}
+
+static void scene_splash(pcd8544_handle_t* lcd, uint32_t frame) {
+    // The splash is shown, then the screen is cleared again
+    if (frame % 2)
+        pcd8544_clear(lcd);
+    else
+        pcd8544_draw_bitmap(lcd, s_splash);
+}
+
+static void bench_scene(pcd8544_handle_t* lcd, const char* name,
+                        bench_scene_t scene) {
+    pcd8544_stats_t stats;
+
+    pcd8544_clear(lcd);
+    pcd8544_flush(lcd);
+    pcd8544_reset_stats(lcd);
+
+    int64_t start = esp_timer_get_time();
+    for (uint32_t frame = 0; frame < BENCH_SCENE_FRAMES; frame++) {
+        scene(lcd, frame);
+        pcd8544_flush(lcd);
+    }
+    int64_t elapsed = esp_timer_get_time() - start;
+
+    pcd8544_get_stats(lcd, &stats);
+    printf("%-20s %10.1f us/frame %8.1f bytes/frame %6.1f trans/frame\n", name,
+           (double)elapsed / BENCH_SCENE_FRAMES,
+           (double)(stats.cmd_bytes + stats.data_bytes) / BENCH_SCENE_FRAMES,
+           (double)stats.transactions / BENCH_SCENE_FRAMES);
+}
+
+int main(void) {
+    pcd8544_handle_t*   lcd;
+    pcd8544_io_config_t io_config = {
+        .rst_gpio_num = 5,
+        .ce_gpio_num  = BENCH_CE_GPIO,
+        .dc_gpio_num  = 19,
+        .bkl_gpio_num = -1,
+    };
+
+    if (pcd8544_init(SPI2_HOST, &io_config, &lcd) != ESP_OK) return 1;
+
+    for (size_t i = 0; i < sizeof(s_splash); i++)
+        s_splash[i] = (i * 37) ^ (i >> 3);
+    for (size_t i = 0; i < sizeof(s_icon); i++) {
+        s_icon[i]      = i * 53;
+        s_icon_mask[i] = ~(i * 11);
+    }
+
+    printf("Primitives\n");
+    bench_op(lcd, "draw_pixel", op_pixel, 1000000);
+    bench_op(lcd, "draw_line", op_line, 100000);
+    bench_op(lcd, "draw_line (h)", op_hline, 100000);
+    bench_op(lcd, "draw_rectagle", op_rect, 100000);
+    bench_op(lcd, "draw_rectagle (f)", op_rect_filled, 100000);
+    bench_op(lcd, "draw_circle", op_circle, 100000);
+    bench_op(lcd, "draw_circle (f)", op_circle_filled, 20000);
+    bench_op(lcd, "blit", op_blit, 1000000);
+    bench_op(lcd, "blit (xor)", op_blit_xor, 1000000);
+    bench_op(lcd, "putc", op_putc, 1000000);
+    bench_op(lcd, "puts", op_puts, 100000);
+    bench_op(lcd, "puts_font (12x24)", op_puts_big, 100000);
+    bench_op(lcd, "put_fixed", op_put_fixed, 100000);
+    bench_op(lcd, "scroll", op_scroll, 10000);
+    bench_op(lcd, "flush", op_flush, 100000);
+
+    printf("\nScenes (%u frames)\n", BENCH_SCENE_FRAMES);
+    bench_scene(lcd, "full clear", scene_clear);
+    bench_scene(lcd, "text dashboard", scene_dashboard);
+    bench_scene(lcd, "scrolling graph", scene_graph);
+    bench_scene(lcd, "bitmap splash", scene_splash);
+
+    pcd8544_deinit(lcd);
+    return 0;
+}
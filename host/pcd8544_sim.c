@@ -0,0 +1,362 @@
+#include "pcd8544_sim.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "driver/gpio.h"
+#include "driver/ledc.h"
+#include "driver/spi_master.h"
+
+// Stand-ins for the IDF SPI master, GPIO and LEDC drivers. Every byte clocked
+// out to a device is fed into a model of the PCD8544 controller attached to
+// its CE line: commands update the addressing state, data lands in the RAM.
+// Queued transactions are executed right away and their results are kept
+// until collected, like on the real bus.
+
+#define SIM_MAX_DEVICES 8
+#define SIM_MAX_GPIO    64
+
+typedef struct {
+    pcd8544_sim_panel_t panel;
+    pcd8544_sim_stats_t stats;
+    int                 ce_gpio_num;
+    bool                used;
+    uint32_t            fail_skip;   // Transactions to let through first
+    uint32_t            fail_count;  // Transactions to fail after that
+} sim_slot_t;
+
+struct spi_device_t {
+    spi_host_device_t             host;
+    spi_device_interface_config_t cfg;
+    sim_slot_t*                   slot;
+    spi_transaction_t**           results;
+    int                           head;
+    int                           count;
+};
+
+static sim_slot_t          s_slots[SIM_MAX_DEVICES];
+static uint32_t            s_gpio_level[SIM_MAX_GPIO];
+static int                 s_last_level = -1;
+static spi_device_handle_t s_bus_owner[SPI_HOST_MAX];
+static pthread_mutex_t     s_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static sim_slot_t* sim_find(int ce_gpio_num) {
+    for (int i = 0; i < SIM_MAX_DEVICES; i++) {
+        if (s_slots[i].used && s_slots[i].ce_gpio_num == ce_gpio_num)
+            return &s_slots[i];
+    }
+    return NULL;
+}
+
+static void sim_command(pcd8544_sim_panel_t* p, uint8_t cmd) {
+    if ((cmd & 0xE0) == 0x20) {
+        // Function set is available in both instruction sets
+        p->power_down = (cmd >> 2) & 1;
+        p->vertical   = (cmd >> 1) & 1;
+        p->extended   = cmd & 1;
+        return;
+    }
+
+    if (p->extended) {
+        if (cmd & 0x80)
+            p->vop = cmd & 0x7F;
+        else if ((cmd & 0xF8) == 0x10)
+            p->bias = cmd & 0x07;
+        else if ((cmd & 0xFC) == 0x04)
+            p->temp = cmd & 0x03;
+        return;
+    }
+
+    if (cmd & 0x80) {
+        if ((cmd & 0x7F) < PCD8544_SIM_COLS) p->x = cmd & 0x7F;
+    } else if (cmd & 0x40) {
+        if ((cmd & 0x07) < PCD8544_SIM_BANKS) p->y = cmd & 0x07;
+    } else if ((cmd & 0xF8) == 0x08) {
+        p->display_control = cmd & 0x05;
+    }
+}
+
+static void sim_data(pcd8544_sim_panel_t* p, uint8_t data) {
+    p->ram[p->y * PCD8544_SIM_COLS + p->x] = data;
+
+    if (p->vertical) {
+        if (++p->y >= PCD8544_SIM_BANKS) {
+            p->y = 0;
+            if (++p->x >= PCD8544_SIM_COLS) p->x = 0;
+        }
+    } else {
+        if (++p->x >= PCD8544_SIM_COLS) {
+            p->x = 0;
+            if (++p->y >= PCD8544_SIM_BANKS) p->y = 0;
+        }
+    }
+}
+
+// Whether the next transaction of a device fails, see pcd8544_sim_fail()
+static bool sim_fails(spi_device_handle_t dev) {
+    sim_slot_t* slot = dev->slot;
+    bool        fail = false;
+
+    pthread_mutex_lock(&s_lock);
+    if (slot->fail_skip) {
+        slot->fail_skip--;
+    } else if (slot->fail_count) {
+        slot->fail_count--;
+        fail = true;
+    }
+    pthread_mutex_unlock(&s_lock);
+    return fail;
+}
+
+static void sim_execute(spi_device_handle_t dev, spi_transaction_t* t) {
+    // The D/C line is whatever the pre-transfer callback drives last
+    s_last_level = -1;
+    if (dev->cfg.pre_cb) dev->cfg.pre_cb(t);
+    int dc = s_last_level;
+
+    const uint8_t* tx = (t->flags & SPI_TRANS_USE_TXDATA)
+                            ? t->tx_data
+                            : (const uint8_t*)t->tx_buffer;
+    size_t len = t->length / 8;
+
+    pthread_mutex_lock(&s_lock);
+    sim_slot_t* slot = dev->slot;
+    slot->stats.transactions++;
+    for (size_t i = 0; i < len; i++) {
+        if (dc == 0) {
+            sim_command(&slot->panel, tx[i]);
+            slot->stats.cmd_bytes++;
+        } else {
+            sim_data(&slot->panel, tx[i]);
+            slot->stats.data_bytes++;
+        }
+    }
+    pthread_mutex_unlock(&s_lock);
+
+    if (dev->cfg.post_cb) dev->cfg.post_cb(t);
+
+    // A real transfer takes a while, let other tasks in between transfers
+    // like the bus would
+    sched_yield();
+}
+
+esp_err_t spi_bus_initialize(spi_host_device_t       host_id,
+                             const spi_bus_config_t* bus_config,
+                             int                     dma_chan) {
+    (void)bus_config;
+    (void)dma_chan;
+    return host_id < SPI_HOST_MAX ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t spi_bus_free(spi_host_device_t host_id) {
+    return host_id < SPI_HOST_MAX ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t spi_bus_add_device(spi_host_device_t                    host_id,
+                             const spi_device_interface_config_t* dev_config,
+                             spi_device_handle_t*                 handle) {
+    if (host_id >= SPI_HOST_MAX || !dev_config || !handle)
+        return ESP_ERR_INVALID_ARG;
+
+    sim_slot_t* slot = sim_find(dev_config->spics_io_num);
+    for (int i = 0; !slot && i < SIM_MAX_DEVICES; i++) {
+        if (!s_slots[i].used) slot = &s_slots[i];
+    }
+    if (!slot) return ESP_ERR_NOT_FOUND;
+
+    memset(slot, 0, sizeof(sim_slot_t));
+    slot->used        = true;
+    slot->ce_gpio_num = dev_config->spics_io_num;
+    // The controller powers up in power-down mode
+    slot->panel.power_down = true;
+
+    spi_device_handle_t dev = calloc(1, sizeof(struct spi_device_t));
+    dev->host               = host_id;
+    dev->cfg                = *dev_config;
+    dev->slot               = slot;
+    dev->results =
+        calloc(dev_config->queue_size > 0 ? dev_config->queue_size : 1,
+               sizeof(spi_transaction_t*));
+    *handle = dev;
+    return ESP_OK;
+}
+
+esp_err_t spi_bus_remove_device(spi_device_handle_t handle) {
+    if (!handle) return ESP_ERR_INVALID_ARG;
+    if (handle->count) return ESP_ERR_INVALID_STATE;
+    if (s_bus_owner[handle->host] == handle) s_bus_owner[handle->host] = NULL;
+    // Keep the panel model around, a real panel keeps showing its RAM
+    free(handle->results);
+    free(handle);
+    return ESP_OK;
+}
+
+esp_err_t spi_device_queue_trans(spi_device_handle_t handle,
+                                 spi_transaction_t*  trans_desc,
+                                 TickType_t          ticks_to_wait) {
+    (void)ticks_to_wait;
+    if (!handle || !trans_desc) return ESP_ERR_INVALID_ARG;
+    if (handle->count >= handle->cfg.queue_size) return ESP_ERR_TIMEOUT;
+    if (sim_fails(handle)) return ESP_FAIL;
+
+    // Transfers complete instantly; results wait until they are collected
+    sim_execute(handle, trans_desc);
+    handle->results[(handle->head + handle->count) % handle->cfg.queue_size] =
+        trans_desc;
+    handle->count++;
+    return ESP_OK;
+}
+
+esp_err_t spi_device_get_trans_result(spi_device_handle_t handle,
+                                      spi_transaction_t** trans_desc,
+                                      TickType_t          ticks_to_wait) {
+    (void)ticks_to_wait;
+    if (!handle || !trans_desc) return ESP_ERR_INVALID_ARG;
+    if (!handle->count) return ESP_ERR_TIMEOUT;
+
+    *trans_desc  = handle->results[handle->head];
+    handle->head = (handle->head + 1) % handle->cfg.queue_size;
+    handle->count--;
+    return ESP_OK;
+}
+
+esp_err_t spi_device_transmit(spi_device_handle_t handle,
+                              spi_transaction_t*  trans_desc) {
+    spi_transaction_t* done;
+    esp_err_t ret = spi_device_queue_trans(handle, trans_desc, portMAX_DELAY);
+    if (ret != ESP_OK) return ret;
+    return spi_device_get_trans_result(handle, &done, portMAX_DELAY);
+}
+
+esp_err_t spi_device_polling_transmit(spi_device_handle_t handle,
+                                      spi_transaction_t*  trans_desc) {
+    if (!handle || !trans_desc) return ESP_ERR_INVALID_ARG;
+    // Same restriction as the real driver: no polling while queued
+    // transactions have not been collected yet
+    if (handle->count) return ESP_ERR_INVALID_STATE;
+    if (sim_fails(handle)) return ESP_FAIL;
+    sim_execute(handle, trans_desc);
+    return ESP_OK;
+}
+
+esp_err_t spi_device_acquire_bus(spi_device_handle_t device, TickType_t wait) {
+    (void)wait;
+    if (!device) return ESP_ERR_INVALID_ARG;
+    if (s_bus_owner[device->host] && s_bus_owner[device->host] != device)
+        return ESP_ERR_INVALID_STATE;
+    s_bus_owner[device->host] = device;
+    return ESP_OK;
+}
+
+void spi_device_release_bus(spi_device_handle_t dev) {
+    if (dev && s_bus_owner[dev->host] == dev) s_bus_owner[dev->host] = NULL;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level) {
+    if (gpio_num < 0 || gpio_num >= SIM_MAX_GPIO) return ESP_ERR_INVALID_ARG;
+    s_gpio_level[gpio_num] = level;
+    s_last_level           = level ? 1 : 0;
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_direction(gpio_num_t gpio_num, gpio_mode_t mode) {
+    (void)mode;
+    if (gpio_num < 0 || gpio_num >= SIM_MAX_GPIO) return ESP_ERR_INVALID_ARG;
+    return ESP_OK;
+}
+
+esp_err_t gpio_reset_pin(gpio_num_t gpio_num) {
+    if (gpio_num < 0 || gpio_num >= SIM_MAX_GPIO) return ESP_ERR_INVALID_ARG;
+    s_gpio_level[gpio_num] = 0;
+    return ESP_OK;
+}
+
+esp_err_t ledc_timer_config(const ledc_timer_config_t* timer_conf) {
+    return timer_conf ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t ledc_channel_config(const ledc_channel_config_t* ledc_conf) {
+    return ledc_conf ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t ledc_fade_func_install(int intr_alloc_flags) {
+    (void)intr_alloc_flags;
+    return ESP_OK;
+}
+
+esp_err_t ledc_set_duty(ledc_mode_t speed_mode, ledc_channel_t channel,
+                        uint32_t duty) {
+    (void)speed_mode;
+    (void)duty;
+    return channel < LEDC_CHANNEL_MAX ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t ledc_update_duty(ledc_mode_t speed_mode, ledc_channel_t channel) {
+    (void)speed_mode;
+    return channel < LEDC_CHANNEL_MAX ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t ledc_set_fade_with_time(ledc_mode_t speed_mode,
+                                  ledc_channel_t channel, uint32_t target_duty,
+                                  int max_fade_time_ms) {
+    (void)speed_mode;
+    (void)target_duty;
+    (void)max_fade_time_ms;
+    return channel < LEDC_CHANNEL_MAX ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t ledc_fade_start(ledc_mode_t speed_mode, ledc_channel_t channel,
+                          ledc_fade_mode_t fade_mode) {
+    (void)speed_mode;
+    (void)fade_mode;
+    return channel < LEDC_CHANNEL_MAX ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+const pcd8544_sim_panel_t* pcd8544_sim_panel(int ce_gpio_num) {
+    sim_slot_t* slot = sim_find(ce_gpio_num);
+    return slot ? &slot->panel : NULL;
+}
+
+bool pcd8544_sim_get_pixel(int ce_gpio_num, uint8_t x, uint8_t y) {
+    sim_slot_t* slot = sim_find(ce_gpio_num);
+    if (!slot || x >= PCD8544_SIM_COLS || y >= PCD8544_SIM_BANKS * 8)
+        return false;
+    return (slot->panel.ram[(y / 8) * PCD8544_SIM_COLS + x] >> (y % 8)) & 1;
+}
+
+void pcd8544_sim_get_stats(int ce_gpio_num, pcd8544_sim_stats_t* stats) {
+    sim_slot_t* slot = sim_find(ce_gpio_num);
+    pthread_mutex_lock(&s_lock);
+    if (slot)
+        *stats = slot->stats;
+    else
+        memset(stats, 0, sizeof(pcd8544_sim_stats_t));
+    pthread_mutex_unlock(&s_lock);
+}
+
+void pcd8544_sim_reset_stats(int ce_gpio_num) {
+    sim_slot_t* slot = sim_find(ce_gpio_num);
+    if (!slot) return;
+    pthread_mutex_lock(&s_lock);
+    memset(&slot->stats, 0, sizeof(pcd8544_sim_stats_t));
+    pthread_mutex_unlock(&s_lock);
+}
+
+void pcd8544_sim_fail(int ce_gpio_num, uint32_t skip, uint32_t count) {
+    sim_slot_t* slot = sim_find(ce_gpio_num);
+    if (!slot) return;
+    pthread_mutex_lock(&s_lock);
+    slot->fail_skip  = skip;
+    slot->fail_count = count;
+    pthread_mutex_unlock(&s_lock);
+}
+
+void pcd8544_sim_dump(int ce_gpio_num, FILE* out) {
+    for (uint8_t y = 0; y < PCD8544_SIM_BANKS * 8; y++) {
+        for (uint8_t x = 0; x < PCD8544_SIM_COLS; x++)
+            fputc(pcd8544_sim_get_pixel(ce_gpio_num, x, y) ? '#' : '.', out);
+        fputc('\n', out);
+    }
+}
@@ -0,0 +1,1284 @@
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "pcd8544.h"
+#include "pcd8544_priv.h"
+#include "pcd8544_sim.h"
+#include "sys/param.h"
+
+// Checks of the driver against the simulated controller: what ends up on the
+// panel, and what it costs on the bus to get it there. Every test starts from
+// a blank, flushed display.
+
+#define TEST_CE_GPIO   18
+#define TEST_CE_GPIO_2 21
+// A 5x7 character cell, glyph and spacing column
+#define TEST_CHAR_WIDTH 6
+
+#define CHECK(cond)                                                    \
+    do {                                                               \
+        if (!(cond)) {                                                 \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__,  \
+                   #cond);                                             \
+            s_failures++;                                              \
+        }                                                              \
+    } while (0)
+
+typedef void (*test_fn_t)(pcd8544_handle_t* lcd);
+
+static int s_failures;
+
+static pcd8544_handle_t* test_init(int ce_gpio_num) {
+    pcd8544_handle_t*   lcd;
+    pcd8544_io_config_t io_config = {
+        .rst_gpio_num = 5,
+        .ce_gpio_num  = ce_gpio_num,
+        .dc_gpio_num  = 19,
+        .bkl_gpio_num = -1,
+    };
+
+    if (pcd8544_init(SPI2_HOST, &io_config, &lcd) != ESP_OK) return NULL;
+    return lcd;
+}
+
+// Whether the panel shows exactly what is in the buffer
+static bool test_panel_is_buffer(pcd8544_handle_t* lcd, int ce_gpio_num) {
+    const pcd8544_sim_panel_t* panel = pcd8544_sim_panel(ce_gpio_num);
+    return memcmp(panel->ram, lcd->buffer, PCD8544_BUFFER_SIZE) == 0;
+}
+
+// Pixels of a buffer in the display layout, the reference the drawing calls
+// are checked against
+static bool test_get(const uint8_t* buffer, int16_t x, int16_t y) {
+    return buffer[(y / 8) * PCD8544_H_RES_MAX + x] >> (y % 8) & 1;
+}
+
+static void test_set(uint8_t* buffer, int16_t x, int16_t y, bool on) {
+    uint8_t* p = &buffer[(y / 8) * PCD8544_H_RES_MAX + x];
+
+    *p = on ? *p | 1 << (y % 8) : *p & ~(1 << (y % 8));
+}
+
+// A screen of bytes that differ all over, drawn into the buffer
+static void test_pattern(pcd8544_handle_t* lcd, uint8_t* pattern) {
+    for (size_t i = 0; i < PCD8544_BUFFER_SIZE; i++)
+        pattern[i] = (i * 29) ^ (i >> 2);
+    pcd8544_draw_bitmap(lcd, pattern);
+}
+
+static void test_flush(pcd8544_handle_t* lcd) {
+    pcd8544_sim_stats_t stats;
+
+    // A single pixel is one address command and one data byte
+    pcd8544_sim_reset_stats(TEST_CE_GPIO);
+    pcd8544_draw_pixel(lcd, 10, 10, PCD8544_PIXEL_BLACK);
+    pcd8544_flush(lcd);
+    pcd8544_sim_get_stats(TEST_CE_GPIO, &stats);
+    CHECK(pcd8544_sim_get_pixel(TEST_CE_GPIO, 10, 10));
+    CHECK(stats.transactions == 2);
+    CHECK(stats.cmd_bytes == 2);
+    CHECK(stats.data_bytes == 1);
+
+    // Nothing changed, nothing is sent
+    pcd8544_sim_reset_stats(TEST_CE_GPIO);
+    pcd8544_flush(lcd);
+    pcd8544_sim_get_stats(TEST_CE_GPIO, &stats);
+    CHECK(stats.transactions == 0);
+
+    // Redrawing the same pixel after a clear sends nothing either
+    pcd8544_clear(lcd);
+    pcd8544_draw_pixel(lcd, 10, 10, PCD8544_PIXEL_BLACK);
+    pcd8544_flush(lcd);
+    pcd8544_sim_get_stats(TEST_CE_GPIO, &stats);
+    CHECK(stats.transactions == 0);
+
+    // A full screen goes out as one run
+    pcd8544_sim_reset_stats(TEST_CE_GPIO);
+    pcd8544_draw_rectagle(lcd, 0, 0, PCD8544_H_RES_MAX - 1,
+                          PCD8544_V_RES_MAX - 1, PCD8544_PIXEL_BLACK, true);
+    pcd8544_flush(lcd);
+    pcd8544_sim_get_stats(TEST_CE_GPIO, &stats);
+    CHECK(test_panel_is_buffer(lcd, TEST_CE_GPIO));
+    CHECK(stats.transactions == 2);
+    CHECK(stats.data_bytes == PCD8544_BUFFER_SIZE);
+}
+
+static void test_flush_error(pcd8544_handle_t* lcd) {
+    // Two runs, the second one does not reach the panel
+    pcd8544_draw_pixel(lcd, 0, 0, PCD8544_PIXEL_BLACK);
+    pcd8544_draw_pixel(lcd, 80, 40, PCD8544_PIXEL_BLACK);
+    pcd8544_sim_fail(TEST_CE_GPIO, 2, 1);
+    CHECK(pcd8544_flush(lcd) == ESP_FAIL);
+    CHECK(pcd8544_sim_get_pixel(TEST_CE_GPIO, 0, 0));
+    CHECK(!pcd8544_sim_get_pixel(TEST_CE_GPIO, 80, 40));
+
+    // Nothing is known of the panel after that, the next flush sends it all
+    pcd8544_sim_stats_t stats;
+
+    pcd8544_sim_reset_stats(TEST_CE_GPIO);
+    CHECK(pcd8544_flush(lcd) == ESP_OK);
+    pcd8544_sim_get_stats(TEST_CE_GPIO, &stats);
+    CHECK(test_panel_is_buffer(lcd, TEST_CE_GPIO));
+    CHECK(stats.data_bytes == PCD8544_BUFFER_SIZE);
+
+    // Same for a transfer that can not be queued
+    pcd8544_draw_pixel(lcd, 40, 20, PCD8544_PIXEL_BLACK);
+    pcd8544_sim_fail(TEST_CE_GPIO, 0, 1);
+    CHECK(pcd8544_flush_async(lcd, NULL, NULL) == ESP_FAIL);
+    CHECK(pcd8544_flush_wait(lcd, portMAX_DELAY) == ESP_OK);
+    CHECK(!pcd8544_sim_get_pixel(TEST_CE_GPIO, 40, 20));
+    CHECK(pcd8544_flush(lcd) == ESP_OK);
+    CHECK(test_panel_is_buffer(lcd, TEST_CE_GPIO));
+
+    // A character of terminal mode that fails is sent by the next flush
+    pcd8544_set_terminal_mode(lcd, true);
+    pcd8544_goto_xy(lcd, 0, 8);
+    pcd8544_sim_fail(TEST_CE_GPIO, 0, 1);
+    pcd8544_putc(lcd, PCD8544_FONT_5x7, PCD8544_PIXEL_BLACK, 'E');
+    CHECK(!test_panel_is_buffer(lcd, TEST_CE_GPIO));
+    pcd8544_set_terminal_mode(lcd, false);
+    CHECK(pcd8544_flush(lcd) == ESP_OK);
+    CHECK(test_panel_is_buffer(lcd, TEST_CE_GPIO));
+}
+
+static void test_flush_done(void* user_ctx) { (*(int*)user_ctx)++; }
+
+static void test_flush_async(pcd8544_handle_t* lcd) {
+    pcd8544_stats_t stats;
+    int             done = 0;
+
+    pcd8544_reset_stats(lcd);
+    pcd8544_draw_line(lcd, 0, 20, PCD8544_H_RES_MAX - 1, 20,
+                      PCD8544_PIXEL_BLACK);
+    CHECK(pcd8544_flush_async(lcd, test_flush_done, &done) == ESP_OK);
+    CHECK(pcd8544_flush_wait(lcd, portMAX_DELAY) == ESP_OK);
+    CHECK(done == 1);
+    CHECK(test_panel_is_buffer(lcd, TEST_CE_GPIO));
+
+    pcd8544_get_stats(lcd, &stats);
+    CHECK(stats.flushes == 1);
+    CHECK(stats.transactions == 2);
+    CHECK(stats.data_bytes == PCD8544_H_RES_MAX);
+
+    // With nothing to send the callback runs right away
+    CHECK(pcd8544_flush_async(lcd, test_flush_done, &done) == ESP_OK);
+    CHECK(done == 2);
+
+    // Drawing goes on while a flush is in flight, the next one sends it
+    pcd8544_draw_pixel(lcd, 0, 0, PCD8544_PIXEL_BLACK);
+    pcd8544_flush_async(lcd, NULL, NULL);
+    pcd8544_draw_pixel(lcd, 83, 47, PCD8544_PIXEL_BLACK);
+    pcd8544_flush(lcd);
+    CHECK(test_panel_is_buffer(lcd, TEST_CE_GPIO));
+}
+
+static void test_flush_multi(pcd8544_handle_t* lcd) {
+    pcd8544_handle_t* lcd2 = test_init(TEST_CE_GPIO_2);
+
+    CHECK(lcd2 != NULL);
+    if (!lcd2) return;
+
+    pcd8544_handle_t* const handles[] = {lcd, lcd2};
+
+    pcd8544_draw_circle(lcd, 20, 20, 10, PCD8544_PIXEL_BLACK, true);
+    pcd8544_draw_rectagle(lcd2, 30, 5, 70, 40, PCD8544_PIXEL_BLACK, false);
+    CHECK(pcd8544_flush_multi(handles, 2) == ESP_OK);
+    CHECK(test_panel_is_buffer(lcd, TEST_CE_GPIO));
+    CHECK(test_panel_is_buffer(lcd2, TEST_CE_GPIO_2));
+    CHECK(pcd8544_sim_get_pixel(TEST_CE_GPIO, 20, 20));
+    CHECK(!pcd8544_sim_get_pixel(TEST_CE_GPIO_2, 20, 20));
+    CHECK(pcd8544_sim_get_pixel(TEST_CE_GPIO_2, 30, 5));
+
+    // An error on one display is reported, the one before it is still sent
+    pcd8544_draw_pixel(lcd, 1, 1, PCD8544_PIXEL_BLACK);
+    pcd8544_draw_pixel(lcd2, 1, 1, PCD8544_PIXEL_BLACK);
+    pcd8544_sim_fail(TEST_CE_GPIO_2, 0, 1);
+    CHECK(pcd8544_flush_multi(handles, 2) == ESP_FAIL);
+    CHECK(test_panel_is_buffer(lcd, TEST_CE_GPIO));
+    CHECK(!pcd8544_sim_get_pixel(TEST_CE_GPIO_2, 1, 1));
+    CHECK(pcd8544_flush_multi(handles, 2) == ESP_OK);
+    CHECK(test_panel_is_buffer(lcd2, TEST_CE_GPIO_2));
+
+    pcd8544_deinit(lcd2);
+}
+
+// Shift an area of buffer pixel by pixel, the way pcd8544_scroll_area() does
+static void test_shift(uint8_t* buffer, uint8_t x0, uint8_t y0, uint8_t x1,
+                       uint8_t y1, int8_t dx, int8_t dy) {
+    uint8_t src[PCD8544_BUFFER_SIZE];
+
+    memcpy(src, buffer, sizeof(src));
+    for (int16_t y = y0; y <= y1; y++) {
+        for (int16_t x = x0; x <= x1; x++) {
+            int16_t sx = x - dx, sy = y - dy;
+            bool    in = sx >= x0 && sx <= x1 && sy >= y0 && sy <= y1;
+
+            test_set(buffer, x, y, in && test_get(src, sx, sy));
+        }
+    }
+}
+
+static void test_scroll(pcd8544_handle_t* lcd) {
+    static const struct {
+        uint8_t x0, y0, x1, y1;
+        int8_t  dx, dy;
+    } cases[] = {
+        {0, 0, 83, 47, 5, 0},      // Whole banks, bytes move right
+        {10, 3, 60, 20, -7, 0},    // Part of the rows of a bank
+        {10, 3, 60, 20, 9, 0},     // and to the right
+        {0, 8, 83, 39, 0, 8},      // Whole banks move down a bank
+        {0, 8, 83, 39, 0, -16},    // and up two
+        {5, 5, 70, 42, 0, 3},      // Column bits across banks
+        {5, 5, 70, 42, -4, -11},   // Both at once
+        {20, 10, 30, 20, 15, 0},   // Everything shifted out
+        {70, 40, 100, 60, 0, -2},  // Clipped to the display
+    };
+    uint8_t pattern[PCD8544_BUFFER_SIZE];
+    uint8_t expect[PCD8544_BUFFER_SIZE];
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        test_pattern(lcd, pattern);
+        memcpy(expect, pattern, sizeof(expect));
+        test_shift(expect, cases[i].x0, cases[i].y0, MIN(cases[i].x1, 83),
+                   MIN(cases[i].y1, 47), cases[i].dx, cases[i].dy);
+
+        CHECK(pcd8544_scroll_area(lcd, cases[i].x0, cases[i].y0, cases[i].x1,
+                                  cases[i].y1, cases[i].dx,
+                                  cases[i].dy) == ESP_OK);
+        if (memcmp(expect, lcd->buffer, PCD8544_BUFFER_SIZE) != 0) {
+            printf("scroll case %zu differs\n", i);
+            CHECK(false);
+        }
+    }
+
+    // A pixel lands where it should, the bytes around it stay blank
+    pcd8544_clear(lcd);
+    pcd8544_draw_pixel(lcd, 10, 3, PCD8544_PIXEL_BLACK);
+    pcd8544_scroll_area(lcd, 0, 0, 83, 47, 5, 7);
+    CHECK(lcd->buffer[10] == 0);
+    CHECK(lcd->buffer[15] == 0);
+    CHECK(lcd->buffer[PCD8544_H_RES_MAX + 15] == 1 << 2);
+
+    // The whole display scrolls and goes out with the flush
+    pcd8544_sim_stats_t stats;
+
+    test_pattern(lcd, pattern);
+    pcd8544_flush(lcd);
+    memcpy(expect, pattern, sizeof(expect));
+    test_shift(expect, 0, 0, 83, 47, 0, -8);
+
+    pcd8544_sim_reset_stats(TEST_CE_GPIO);
+    CHECK(pcd8544_scroll(lcd, 0, -8) == ESP_OK);
+    pcd8544_sim_get_stats(TEST_CE_GPIO, &stats);
+    CHECK(memcmp(expect, lcd->buffer, PCD8544_BUFFER_SIZE) == 0);
+    CHECK(memcmp(&lcd->buffer[0], &pattern[PCD8544_H_RES_MAX],
+                 PCD8544_H_RES_MAX) == 0);
+    CHECK(test_panel_is_buffer(lcd, TEST_CE_GPIO));
+    CHECK(stats.data_bytes <= PCD8544_BUFFER_SIZE);
+}
+
+static void test_scroll_smooth(pcd8544_handle_t* lcd) {
+    uint8_t         pattern[PCD8544_BUFFER_SIZE];
+    uint8_t         expect[PCD8544_BUFFER_SIZE];
+    pcd8544_stats_t stats;
+
+    // Steps in the same direction add up to one shift of the whole way
+    test_pattern(lcd, pattern);
+    pcd8544_flush(lcd);
+    memcpy(expect, pattern, sizeof(expect));
+    test_shift(expect, 0, 0, 83, 47, 12, -9);
+
+    pcd8544_reset_stats(lcd);
+    CHECK(pcd8544_scroll_smooth(lcd, 12, -9, 240) == ESP_OK);
+    CHECK(pcd8544_scroll_smooth(lcd, 1, 1, 60) == ESP_ERR_INVALID_STATE);
+    CHECK(pcd8544_scroll_smooth_wait(lcd, portMAX_DELAY) == ESP_OK);
+    pcd8544_get_stats(lcd, &stats);
+    CHECK(memcmp(expect, lcd->buffer, PCD8544_BUFFER_SIZE) == 0);
+    CHECK(test_panel_is_buffer(lcd, TEST_CE_GPIO));
+    CHECK(stats.flushes > 1 && stats.flushes <= 12);
+
+    // Without a time it is a plain scroll, done on return
+    test_shift(expect, 0, 0, 83, 47, 0, 8);
+    CHECK(pcd8544_scroll_smooth(lcd, 0, 8, 0) == ESP_OK);
+    CHECK(memcmp(expect, lcd->buffer, PCD8544_BUFFER_SIZE) == 0);
+    CHECK(test_panel_is_buffer(lcd, TEST_CE_GPIO));
+
+    CHECK(pcd8544_scroll_smooth(lcd, 0, 8, -1) == ESP_ERR_INVALID_ARG);
+    CHECK(pcd8544_scroll_smooth_wait(lcd, 0) == ESP_OK);
+}
+
+static void test_render_task(pcd8544_handle_t* lcd) {
+    pcd8544_handle_t* const handles[] = {lcd};
+
+    CHECK(pcd8544_render_start(lcd) == ESP_OK);
+
+    // Frames are left to the task, other flushes keep out of its way
+    pcd8544_draw_rectagle(lcd, 10, 10, 40, 30, PCD8544_PIXEL_BLACK, true);
+    CHECK(pcd8544_flush(lcd) == ESP_OK);
+    CHECK(pcd8544_flush_async(lcd, NULL, NULL) == ESP_ERR_INVALID_STATE);
+    CHECK(pcd8544_flush_multi(handles, 1) == ESP_ERR_INVALID_STATE);
+    CHECK(pcd8544_wait_vsync(lcd, portMAX_DELAY) == ESP_OK);
+    CHECK(pcd8544_wait_vsync(lcd, portMAX_DELAY) == ESP_OK);
+    CHECK(test_panel_is_buffer(lcd, TEST_CE_GPIO));
+
+    // What is drawn after the last frame is sent when the task stops
+    pcd8544_draw_pixel(lcd, 0, 0, PCD8544_PIXEL_BLACK);
+    CHECK(pcd8544_render_stop(lcd) == ESP_OK);
+    CHECK(test_panel_is_buffer(lcd, TEST_CE_GPIO));
+    CHECK(pcd8544_flush_async(lcd, NULL, NULL) == ESP_OK);
+    pcd8544_flush_wait(lcd, portMAX_DELAY);
+}
+
+typedef struct {
+    pcd8544_handle_t* lcd;
+    SemaphoreHandle_t done;
+    uint8_t           row;
+} test_worker_t;
+
+// Draws into its own rows and flushes, next to the other workers
+static void test_worker_task(void* arg) {
+    test_worker_t* worker = arg;
+
+    for (int i = 0; i < 200; i++) {
+        pcd8544_begin(worker->lcd);
+        pcd8544_draw_rectagle(worker->lcd, 0, worker->row,
+                              PCD8544_H_RES_MAX - 1, worker->row + 7,
+                              PCD8544_PIXEL_WHITE, true);
+        pcd8544_draw_line(worker->lcd, 0, worker->row + i % 8, i % 84,
+                          worker->row + i % 8, PCD8544_PIXEL_BLACK);
+        pcd8544_end(worker->lcd);
+
+        if (i % 2)
+            pcd8544_flush(worker->lcd);
+        else
+            pcd8544_flush_async(worker->lcd, NULL, NULL);
+    }
+
+    xSemaphoreGive(worker->done);
+    vTaskDelete(NULL);
+}
+
+static void test_concurrent_flush(pcd8544_handle_t* lcd) {
+    test_worker_t workers[2] = {
+        {.lcd = lcd, .done = xSemaphoreCreateBinary(), .row = 16},
+        {.lcd = lcd, .done = xSemaphoreCreateBinary(), .row = 32},
+    };
+
+    // Terminal mode talks to the controller from inside drawing calls
+    pcd8544_set_terminal_mode(lcd, true);
+    for (int i = 0; i < 2; i++)
+        xTaskCreate(test_worker_task, "worker", 2048, &workers[i], 5, NULL);
+
+    for (int i = 0; i < 200; i++) {
+        pcd8544_begin(lcd);
+        pcd8544_goto_xy(lcd, i % 14 * 6, 0);
+        pcd8544_putc(lcd, PCD8544_FONT_5x7, PCD8544_PIXEL_BLACK, 'a' + i % 26);
+        pcd8544_end(lcd);
+    }
+
+    for (int i = 0; i < 2; i++) {
+        xSemaphoreTake(workers[i].done, portMAX_DELAY);
+        vSemaphoreDelete(workers[i].done);
+    }
+    pcd8544_set_terminal_mode(lcd, false);
+
+    pcd8544_flush(lcd);
+    CHECK(test_panel_is_buffer(lcd, TEST_CE_GPIO));
+
+    // Drawing next to a smooth scroll ends up on the panel as well
+    CHECK(pcd8544_scroll_smooth(lcd, 0, 16, 100) == ESP_OK);
+    for (int i = 0; i < 100; i++) {
+        pcd8544_begin(lcd);
+        pcd8544_draw_pixel(lcd, i % 84, i % 48, PCD8544_PIXEL_XOR);
+        pcd8544_end(lcd);
+        pcd8544_flush(lcd);
+    }
+    CHECK(pcd8544_scroll_smooth_wait(lcd, portMAX_DELAY) == ESP_OK);
+    pcd8544_flush(lcd);
+    CHECK(test_panel_is_buffer(lcd, TEST_CE_GPIO));
+}
+
+static void test_terminal_mode(pcd8544_handle_t* lcd) {
+    pcd8544_sim_stats_t stats;
+
+    pcd8544_set_terminal_mode(lcd, true);
+    pcd8544_goto_xy(lcd, 0, 8);
+
+    // The first character addresses the controller, the next one is written
+    // right after it without a new address
+    pcd8544_sim_reset_stats(TEST_CE_GPIO);
+    pcd8544_putc(lcd, PCD8544_FONT_5x7, PCD8544_PIXEL_BLACK, 'H');
+    pcd8544_putc(lcd, PCD8544_FONT_5x7, PCD8544_PIXEL_BLACK, 'i');
+    pcd8544_sim_get_stats(TEST_CE_GPIO, &stats);
+    CHECK(stats.transactions == 3);
+    CHECK(stats.cmd_bytes == 2);
+    CHECK(stats.data_bytes == 2 * TEST_CHAR_WIDTH);
+    CHECK(test_panel_is_buffer(lcd, TEST_CE_GPIO));
+
+    // Already on the panel, the flush has nothing left to send
+    pcd8544_sim_reset_stats(TEST_CE_GPIO);
+    pcd8544_flush(lcd);
+    pcd8544_sim_get_stats(TEST_CE_GPIO, &stats);
+    CHECK(stats.transactions == 0);
+
+    // Rows off the banks go through the buffer
+    pcd8544_goto_xy(lcd, 0, 20);
+    pcd8544_putc(lcd, PCD8544_FONT_5x7, PCD8544_PIXEL_BLACK, 'H');
+    pcd8544_sim_get_stats(TEST_CE_GPIO, &stats);
+    CHECK(stats.transactions == 0);
+    pcd8544_flush(lcd);
+    CHECK(test_panel_is_buffer(lcd, TEST_CE_GPIO));
+
+    // Every color draws the same straight to the panel as into the buffer
+    static const pcd8544_pixel_color_t colors[] = {
+        PCD8544_PIXEL_WHITE, PCD8544_PIXEL_BLACK, PCD8544_PIXEL_XOR,
+        PCD8544_PIXEL_COPY};
+    uint8_t expect[PCD8544_BUFFER_SIZE];
+
+    for (size_t i = 0; i < sizeof(colors) / sizeof(colors[0]); i++) {
+        pcd8544_set_terminal_mode(lcd, false);
+        pcd8544_draw_rectagle(lcd, 0, 24, 20, 35, PCD8544_PIXEL_WHITE, true);
+        pcd8544_draw_rectagle(lcd, 2, 26, 16, 30, PCD8544_PIXEL_BLACK, true);
+        pcd8544_flush(lcd);
+
+        pcd8544_goto_xy(lcd, 0, 24);
+        pcd8544_puts(lcd, PCD8544_FONT_5x7, colors[i], "Ab");
+        memcpy(expect, lcd->buffer, PCD8544_BUFFER_SIZE);
+
+        pcd8544_draw_rectagle(lcd, 0, 24, 20, 35, PCD8544_PIXEL_WHITE, true);
+        pcd8544_draw_rectagle(lcd, 2, 26, 16, 30, PCD8544_PIXEL_BLACK, true);
+        pcd8544_flush(lcd);
+
+        pcd8544_set_terminal_mode(lcd, true);
+        pcd8544_goto_xy(lcd, 0, 24);
+        pcd8544_puts(lcd, PCD8544_FONT_5x7, colors[i], "Ab");
+        CHECK(memcmp(expect, lcd->buffer, PCD8544_BUFFER_SIZE) == 0);
+        CHECK(test_panel_is_buffer(lcd, TEST_CE_GPIO));
+    }
+
+    pcd8544_set_terminal_mode(lcd, false);
+}
+
+// Glyph of a code point found by walking the ranges, the reference of the
+// binary search. Draws its set bits black into buffer with the top left at
+// x, y, and returns the advance, 0 when the font has no glyph.
+static uint8_t test_glyph(uint8_t* buffer, const pcd8544_font_desc_t* font,
+                          uint32_t code, int16_t x, int16_t y) {
+    for (uint16_t r = 0; r < font->range_num; r++) {
+        const pcd8544_glyph_range_t* range = &font->ranges[r];
+
+        if (code < range->first || code > range->last) continue;
+
+        pcd8544_glyph_t glyph =
+            font->glyphs[range->glyph + code - range->first];
+
+        for (uint8_t i = 0; i < glyph.width; i++) {
+            for (uint8_t j = 0; j < font->height; j++) {
+                uint32_t bit = glyph.offset + i * font->stride + j;
+
+                if (font->bitmap[bit / 8] >> (bit % 8) & 1 &&
+                    x + i < PCD8544_H_RES_MAX && y + j < PCD8544_V_RES_MAX)
+                    test_set(buffer, x + i, y + j, true);
+            }
+        }
+        return glyph.advance;
+    }
+    return 0;
+}
+
+static void test_fonts(pcd8544_handle_t* lcd) {
+    uint8_t expect[PCD8544_BUFFER_SIZE] = {0};
+
+    // Digits taller than a bank, off the bank rows and cut at the bottom
+    uint8_t x = 3;
+
+    x += test_glyph(expect, &pcd8544_font_8x16_digits, '4', x, 5);
+    x += test_glyph(expect, &pcd8544_font_8x16_digits, '-', x, 5);
+    x += test_glyph(expect, &pcd8544_font_8x16_digits, '7', x, 5);
+    test_glyph(expect, &pcd8544_font_12x24_digits, '2', 40, 3);
+    test_glyph(expect, &pcd8544_font_12x24_digits, '9', 55, 30);
+
+    pcd8544_goto_xy(lcd, 3, 5);
+    CHECK(pcd8544_puts_font(lcd, &pcd8544_font_8x16_digits,
+                            PCD8544_PIXEL_BLACK, "4-7") == ESP_OK);
+    CHECK(lcd->_x == x);
+    pcd8544_goto_xy(lcd, 40, 3);
+    pcd8544_putc_font(lcd, &pcd8544_font_12x24_digits, PCD8544_PIXEL_BLACK,
+                      '2');
+    pcd8544_goto_xy(lcd, 55, 30);
+    pcd8544_putc_font(lcd, &pcd8544_font_12x24_digits, PCD8544_PIXEL_BLACK,
+                      '9');
+    CHECK(memcmp(lcd->buffer, expect, PCD8544_BUFFER_SIZE) == 0);
+    pcd8544_flush(lcd);
+    CHECK(test_panel_is_buffer(lcd, TEST_CE_GPIO));
+
+    // Proportional glyphs advance by their own width, the string takes less
+    // than its fixed cells
+    pcd8544_clear(lcd);
+    memset(expect, 0, sizeof(expect));
+    x = 0;
+    for (const char* c = "Will 1m"; *c; c++)
+        x += test_glyph(expect, &pcd8544_font_5x7_prop, *c, x, 16);
+
+    pcd8544_goto_xy(lcd, 0, 16);
+    pcd8544_puts_font(lcd, &pcd8544_font_5x7_prop, PCD8544_PIXEL_BLACK,
+                      "Will 1m");
+    CHECK(memcmp(lcd->buffer, expect, PCD8544_BUFFER_SIZE) == 0);
+    CHECK(lcd->_x == x);
+    CHECK(x < 7 * TEST_CHAR_WIDTH);
+
+    // Only the pcd8544_font_t values are fonts
+    pcd8544_font_t           bad    = (pcd8544_font_t)(PCD8544_FONT_5x7 + 1);
+    pcd8544_console_config_t config = {bad, 0, 0};
+    pcd8544_console_t*       console;
+    pcd8544_dlist_t*         dlist;
+
+    CHECK(pcd8544_putc(lcd, bad, PCD8544_PIXEL_BLACK, 'a') ==
+          ESP_ERR_INVALID_ARG);
+    CHECK(pcd8544_puts(lcd, bad, PCD8544_PIXEL_BLACK, "a") ==
+          ESP_ERR_INVALID_ARG);
+    CHECK(pcd8544_console_create(lcd, &config, &console) ==
+          ESP_ERR_INVALID_ARG);
+    CHECK(pcd8544_dlist_create(32, &dlist) == ESP_OK);
+    CHECK(pcd8544_dlist_add_text(dlist, 0, 0, bad, PCD8544_PIXEL_BLACK,
+                                 "a") == ESP_ERR_INVALID_ARG);
+    pcd8544_dlist_delete(dlist);
+    CHECK(memcmp(lcd->buffer, expect, PCD8544_BUFFER_SIZE) == 0);
+}
+
+static void test_utf8(pcd8544_handle_t* lcd) {
+    uint8_t expect[PCD8544_BUFFER_SIZE] = {0};
+
+    // Code points between, before and after the ranges of the Latin-1 font
+    // are skipped, the ones in them found: é, ü at the end of the last
+    // range, ¡ alone in one
+    static const char     text[]    = "A\xc3\xa9\xc2\xa2\xd0\x96" "B\xc3\xbc"
+                                      "\xc3\xbd\xe2\x82\xac \xc2\xa1\x01";
+    static const uint32_t decoded[] = {'A',  0xE9,   0xA2, 0x416, 'B', 0xFC,
+                                       0xFD, 0x20AC, ' ',  0xA1,  0x01};
+    uint8_t               x         = 2;
+
+    for (size_t i = 0; i < sizeof(decoded) / sizeof(decoded[0]); i++)
+        x += test_glyph(expect, &pcd8544_font_5x7_prop, decoded[i], x, 8);
+    CHECK(test_glyph(expect, &pcd8544_font_5x7_prop, 0xE9, 0, 40) != 0);
+    CHECK(test_glyph(expect, &pcd8544_font_5x7_prop, 0xFD, 0, 40) == 0);
+    memset(&expect[5 * PCD8544_H_RES_MAX], 0, PCD8544_H_RES_MAX);
+
+    pcd8544_goto_xy(lcd, 2, 8);
+    pcd8544_puts_font(lcd, &pcd8544_font_5x7_prop, PCD8544_PIXEL_BLACK, "%s",
+                      text);
+    CHECK(memcmp(lcd->buffer, expect, PCD8544_BUFFER_SIZE) == 0);
+    CHECK(lcd->_x == x);
+
+    // Malformed sequences are drawn as U+FFFD by a font that has it: a lone
+    // continuation byte, a sequence cut short by the next character, an
+    // overlong form, a surrogate and a sequence cut by the end of the string
+    static const uint8_t               bitmap[] = {0x0F, 0xF0};
+    static const pcd8544_glyph_t       glyphs[] = {{0, 1, 2}, {8, 1, 3}};
+    static const pcd8544_glyph_range_t ranges[] = {{'a', 'a', 0},
+                                                   {0xFFFD, 0xFFFD, 1}};
+    static const pcd8544_font_desc_t   font     = {
+        .bitmap    = bitmap,
+        .glyphs    = glyphs,
+        .ranges    = ranges,
+        .range_num = 2,
+        .height    = 8,
+        .stride    = 8,
+    };
+
+    pcd8544_clear(lcd);
+    memset(expect, 0, sizeof(expect));
+    x = 0;
+    for (const char* c = "a?a?a?a?a?"; *c; c++)
+        x += test_glyph(expect, &font, *c == '?' ? 0xFFFD : 'a', x, 0);
+
+    pcd8544_goto_xy(lcd, 0, 0);
+    pcd8544_puts_font(lcd, &font, PCD8544_PIXEL_BLACK, "%s",
+                      "a\x80" "a\xe2\x82" "a\xc0\xaf" "a\xed\xa0\x80"
+                      "a\xf0\x9f");
+    CHECK(memcmp(lcd->buffer, expect, PCD8544_BUFFER_SIZE) == 0);
+    CHECK(lcd->_x == x);
+
+    // The fixed fonts skip what is not printable ASCII
+    pcd8544_clear(lcd);
+    pcd8544_goto_xy(lcd, 0, 0);
+    pcd8544_puts(lcd, PCD8544_FONT_5x7, PCD8544_PIXEL_BLACK,
+                 "\x01\x7f\xc3\xa9");
+    memset(expect, 0, sizeof(expect));
+    CHECK(memcmp(lcd->buffer, expect, PCD8544_BUFFER_SIZE) == 0);
+    CHECK(lcd->_x == 0);
+}
+
+// 5x7 text drawn black into buffer with its top left at x, y, only the
+// pixels inside x0, y0 ~ x1, y1; what a text box should draw
+static void test_text(uint8_t* buffer, const char* str, int16_t x, int16_t y,
+                      uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1) {
+    const pcd8544_font_desc_t* font = &pcd8544_font_5x7;
+
+    for (; *str; str++, x += font->width + 1) {
+        for (uint8_t i = 0; i < font->width; i++) {
+            uint8_t column =
+                font->bitmap[(*str - font->first) * font->width + i];
+
+            for (uint8_t j = 0; j < font->height; j++)
+                if (column >> j & 1 && x + i >= x0 && x + i <= x1 &&
+                    y + j >= y0 && y + j <= y1)
+                    test_set(buffer, x + i, y + j, true);
+        }
+    }
+}
+
+// The pattern with a cleared box, the background of a text box
+static void test_text_box_clear(uint8_t* expect, uint8_t x0, uint8_t y0,
+                                uint8_t x1, uint8_t y1) {
+    for (uint8_t y = y0; y <= y1; y++)
+        for (uint8_t x = x0; x <= x1; x++) test_set(expect, x, y, false);
+}
+
+static void test_text_box(pcd8544_handle_t* lcd) {
+    const pcd8544_font_desc_t* font = &pcd8544_font_5x7;
+    uint8_t                    expect[PCD8544_BUFFER_SIZE];
+    uint16_t                   width, height;
+
+    // Glyph to glyph, without the spacing after the last one or spaces
+    CHECK(pcd8544_text_extent(font, "12", 0, &width, &height) == ESP_OK);
+    CHECK(width == 11 && height == 8);
+    CHECK(pcd8544_text_extent(font, "ab \ncde", 0, &width, &height) ==
+          ESP_OK);
+    CHECK(width == 17 && height == 16);
+    CHECK(pcd8544_text_extent(font, "", 0, &width, &height) == ESP_OK);
+    CHECK(width == 0 && height == 0);
+
+    // Wrapped at spaces, or inside a word wider than the line
+    CHECK(pcd8544_text_extent(font, "aa bb cc", 20, &width, &height) ==
+          ESP_OK);
+    CHECK(width == 11 && height == 24);
+    CHECK(pcd8544_text_extent(font, "abcdef", 20, &width, &height) ==
+          ESP_OK);
+    CHECK(width == 17 && height == 16);
+    CHECK(pcd8544_text_extent(NULL, "a", 0, &width, &height) ==
+          ESP_ERR_INVALID_ARG);
+
+    // Right aligned in a bank, only the box is sent
+    pcd8544_sim_stats_t stats;
+
+    test_pattern(lcd, expect);
+    pcd8544_flush(lcd);
+    pcd8544_sim_reset_stats(TEST_CE_GPIO);
+    CHECK(pcd8544_draw_text_box(lcd, font, PCD8544_PIXEL_BLACK, 10, 8, 40, 15,
+                                PCD8544_ALIGN_RIGHT, "12") == ESP_OK);
+    test_text_box_clear(expect, 10, 8, 40, 15);
+    test_text(expect, "12", 30, 8, 10, 8, 40, 15);
+    CHECK(memcmp(lcd->buffer, expect, PCD8544_BUFFER_SIZE) == 0);
+    pcd8544_flush(lcd);
+    pcd8544_sim_get_stats(TEST_CE_GPIO, &stats);
+    CHECK(test_panel_is_buffer(lcd, TEST_CE_GPIO));
+    CHECK(stats.data_bytes <= 31);
+
+    // Centred both ways in a box lower than the text: the lines are cut at
+    // the top and the bottom of the box
+    test_pattern(lcd, expect);
+    CHECK(pcd8544_draw_text_box(lcd, font, PCD8544_PIXEL_COPY, 20, 20, 50, 29,
+                                PCD8544_ALIGN_CENTER | PCD8544_ALIGN_MIDDLE,
+                                "ab\ncd") == ESP_OK);
+    test_text_box_clear(expect, 20, 20, 50, 29);
+    test_text(expect, "ab", 30, 17, 20, 20, 50, 29);
+    test_text(expect, "cd", 30, 25, 20, 20, 50, 29);
+    CHECK(memcmp(lcd->buffer, expect, PCD8544_BUFFER_SIZE) == 0);
+
+    // Wrapped and at the bottom, the first of four lines is above the box and
+    // a word wider than the box breaks where it reaches the edge
+    test_pattern(lcd, expect);
+    CHECK(pcd8544_draw_text_box(lcd, font, PCD8544_PIXEL_BLACK, 60, 26, 83, 47,
+                                PCD8544_ALIGN_BOTTOM | PCD8544_TEXT_WRAP,
+                                "aa bb abcdefg") == ESP_OK);
+    test_text_box_clear(expect, 60, 26, 83, 47);
+    test_text(expect, "bb", 60, 24, 60, 26, 83, 47);
+    test_text(expect, "abcd", 60, 32, 60, 26, 83, 47);
+    test_text(expect, "efg", 60, 40, 60, 26, 83, 47);
+    CHECK(memcmp(lcd->buffer, expect, PCD8544_BUFFER_SIZE) == 0);
+
+    // White text on a black box
+    test_pattern(lcd, expect);
+    CHECK(pcd8544_draw_text_box(lcd, font, PCD8544_PIXEL_WHITE, 0, 0, 20, 7,
+                                PCD8544_ALIGN_LEFT, "ok") == ESP_OK);
+    for (uint8_t y = 0; y <= 7; y++)
+        for (uint8_t x = 0; x <= 20; x++) test_set(expect, x, y, true);
+    uint8_t text[PCD8544_BUFFER_SIZE] = {0};
+
+    test_text(text, "ok", 0, 0, 0, 0, 20, 7);
+    for (size_t i = 0; i < PCD8544_H_RES_MAX; i++) expect[i] &= ~text[i];
+    CHECK(memcmp(lcd->buffer, expect, PCD8544_BUFFER_SIZE) == 0);
+}
+
+static void test_xor(pcd8544_handle_t* lcd) {
+    static uint8_t icon[2 * 12];
+    uint8_t        before[PCD8544_BUFFER_SIZE];
+
+    for (size_t i = 0; i < sizeof(icon); i++) icon[i] = i * 37;
+
+    pcd8544_draw_circle(lcd, 42, 24, 20, PCD8544_PIXEL_BLACK, false);
+    pcd8544_goto_xy(lcd, 4, 4);
+    pcd8544_puts(lcd, PCD8544_FONT_5x7, PCD8544_PIXEL_BLACK, "XOR");
+    pcd8544_flush(lcd);
+    memcpy(before, lcd->buffer, PCD8544_BUFFER_SIZE);
+
+    // Every shape drawn twice in XOR leaves the buffer as it was
+    for (int pass = 0; pass < 2; pass++) {
+        pcd8544_draw_pixel(lcd, 42, 24, PCD8544_PIXEL_XOR);
+        pcd8544_draw_line(lcd, 0, 0, 83, 47, PCD8544_PIXEL_XOR);
+        pcd8544_draw_line(lcd, 0, 30, 83, 30, PCD8544_PIXEL_XOR);
+        pcd8544_draw_rectagle(lcd, 5, 3, 60, 40, PCD8544_PIXEL_XOR, false);
+        pcd8544_draw_rectagle(lcd, 10, 10, 30, 21, PCD8544_PIXEL_XOR, true);
+        pcd8544_draw_circle(lcd, 42, 24, 15, PCD8544_PIXEL_XOR, false);
+        pcd8544_draw_circle(lcd, 60, 20, 9, PCD8544_PIXEL_XOR, true);
+        pcd8544_blit_color(lcd, 33, 19, 12, 12, icon, NULL,
+                           PCD8544_PIXEL_XOR);
+        pcd8544_goto_xy(lcd, 2, 13);
+        pcd8544_puts_font(lcd, &pcd8544_font_8x16_digits, PCD8544_PIXEL_XOR,
+                          "%d", 42);
+
+        if (pass == 0)
+            CHECK(memcmp(before, lcd->buffer, PCD8544_BUFFER_SIZE) != 0);
+    }
+    CHECK(memcmp(before, lcd->buffer, PCD8544_BUFFER_SIZE) == 0);
+
+    // Back to what the panel shows, so the flush sends nothing
+    pcd8544_sim_stats_t stats;
+
+    pcd8544_sim_reset_stats(TEST_CE_GPIO);
+    pcd8544_flush(lcd);
+    pcd8544_sim_get_stats(TEST_CE_GPIO, &stats);
+    CHECK(stats.transactions == 0);
+}
+
+static void test_blit(pcd8544_handle_t* lcd) {
+    static const struct {
+        int16_t x, y;
+        uint8_t width, height;
+    } cases[] = {
+        {9, 5, 13, 11},    // inside, across a bank boundary
+        {-6, -3, 17, 13},  // off the top left
+        {70, 38, 20, 19},  // off the bottom right
+        {-4, 20, 92, 5},   // wider than the display
+    };
+    static const pcd8544_pixel_color_t colors[] = {
+        PCD8544_PIXEL_COPY, PCD8544_PIXEL_BLACK, PCD8544_PIXEL_WHITE,
+        PCD8544_PIXEL_XOR};
+    static uint8_t image[3 * 92];
+    static uint8_t mask[3 * 92];
+    uint8_t        pattern[PCD8544_BUFFER_SIZE];
+    uint8_t        expect[PCD8544_BUFFER_SIZE];
+
+    for (size_t i = 0; i < sizeof(image); i++) {
+        image[i] = i * 37 + 5;
+        mask[i]  = (i * 11) ^ 0x5A;
+    }
+
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        for (size_t k = 0; k < sizeof(colors) / sizeof(colors[0]); k++) {
+            for (int masked = 0; masked < 2; masked++) {
+                const uint8_t* m = masked ? mask : NULL;
+
+                test_pattern(lcd, pattern);
+                memcpy(expect, pattern, sizeof(expect));
+
+                // Pixel by pixel, clipped to the display
+                for (int16_t j = 0; j < cases[c].height; j++) {
+                    for (int16_t i = 0; i < cases[c].width; i++) {
+                        int16_t x = cases[c].x + i, y = cases[c].y + j;
+                        size_t  at  = (j / 8) * cases[c].width + i;
+                        bool    bit = image[at] >> (j % 8) & 1;
+
+                        if (x < 0 || y < 0 || x >= PCD8544_H_RES_MAX ||
+                            y >= PCD8544_V_RES_MAX)
+                            continue;
+                        if (m && !(m[at] >> (j % 8) & 1)) continue;
+
+                        if (colors[k] == PCD8544_PIXEL_COPY)
+                            test_set(expect, x, y, bit);
+                        else if (bit && colors[k] == PCD8544_PIXEL_XOR)
+                            test_set(expect, x, y, !test_get(expect, x, y));
+                        else if (bit)
+                            test_set(expect, x, y,
+                                     colors[k] == PCD8544_PIXEL_BLACK);
+                    }
+                }
+
+                if (colors[k] == PCD8544_PIXEL_COPY)
+                    CHECK(pcd8544_blit(lcd, cases[c].x, cases[c].y,
+                                       cases[c].width, cases[c].height, image,
+                                       m) == ESP_OK);
+                else
+                    CHECK(pcd8544_blit_color(lcd, cases[c].x, cases[c].y,
+                                             cases[c].width, cases[c].height,
+                                             image, m, colors[k]) == ESP_OK);
+                CHECK(memcmp(lcd->buffer, expect, sizeof(expect)) == 0);
+            }
+        }
+    }
+
+    // Only the covered area is sent: 13 columns in each of the two banks
+    pcd8544_sim_stats_t stats;
+
+    pcd8544_clear(lcd);
+    pcd8544_flush(lcd);
+    pcd8544_sim_reset_stats(TEST_CE_GPIO);
+    pcd8544_blit(lcd, 9, 5, 13, 11, image, NULL);
+    pcd8544_flush(lcd);
+    pcd8544_sim_get_stats(TEST_CE_GPIO, &stats);
+    CHECK(test_panel_is_buffer(lcd, TEST_CE_GPIO));
+    CHECK(stats.data_bytes <= 2 * 13);
+
+    CHECK(pcd8544_blit(lcd, 0, 0, 8, 8, NULL, NULL) == ESP_ERR_INVALID_ARG);
+}
+
+// Encode a frame the way tools/pcd8544_encode.py does, only the bytes that
+// differ from prev if given. Returns the encoded length.
+static size_t test_rle_encode(const uint8_t* frame, const uint8_t* prev,
+                              uint8_t* out) {
+    size_t   len = 0;
+    uint16_t pos = 0;
+
+    while (pos < PCD8544_BUFFER_SIZE) {
+        uint16_t end = pos;
+        uint8_t  kind;
+
+        if (prev && frame[pos] == prev[pos]) {
+            while (end < PCD8544_BUFFER_SIZE && frame[end] == prev[end])
+                end++;
+            if (end == PCD8544_BUFFER_SIZE) break;
+            kind = 0x00;
+        } else {
+            while (end < PCD8544_BUFFER_SIZE && frame[end] == frame[pos])
+                end++;
+            if (end - pos >= 3) {
+                kind = 0x40;
+            } else {
+                // Literal up to the next repeat or unchanged byte
+                end = pos + 1;
+                while (end < PCD8544_BUFFER_SIZE && end - pos < 64 &&
+                       !(prev && frame[end] == prev[end]) &&
+                       !(end + 2 < PCD8544_BUFFER_SIZE &&
+                         frame[end] == frame[end + 1] &&
+                         frame[end] == frame[end + 2]))
+                    end++;
+                kind = 0x80;
+            }
+        }
+
+        while (pos < end) {
+            uint8_t n = end - pos > 64 ? 64 : end - pos;
+
+            out[len++] = kind | (n - 1);
+            if (kind == 0x40) out[len++] = frame[pos];
+            if (kind == 0x80) {
+                memcpy(&out[len], &frame[pos], n);
+                len += n;
+            }
+            pos += n;
+        }
+    }
+    return len;
+}
+
+static void test_rle(pcd8544_handle_t* lcd) {
+    static uint8_t frame[PCD8544_BUFFER_SIZE];
+    static uint8_t next[PCD8544_BUFFER_SIZE];
+    static uint8_t data[PCD8544_BUFFER_SIZE * 2];
+    size_t         len;
+
+    // Runs, literals and a bit of both across bank boundaries
+    for (size_t i = 0; i < sizeof(frame); i++)
+        frame[i] = i % 100 < 40 ? 0xAA : (i * 29) ^ (i >> 2);
+
+    len = test_rle_encode(frame, NULL, data);
+    CHECK(len < sizeof(frame));
+    CHECK(pcd8544_draw_rle(lcd, data, len) == ESP_OK);
+    CHECK(memcmp(lcd->buffer, frame, sizeof(frame)) == 0);
+    pcd8544_flush(lcd);
+    CHECK(test_panel_is_buffer(lcd, TEST_CE_GPIO));
+
+    // A delta frame only sends the bytes that changed
+    pcd8544_sim_stats_t stats;
+
+    memcpy(next, frame, sizeof(next));
+    memset(&next[100], 0x18, 10);
+    next[400] ^= 0xFF;
+
+    len = test_rle_encode(next, frame, data);
+    pcd8544_sim_reset_stats(TEST_CE_GPIO);
+    CHECK(pcd8544_draw_rle(lcd, data, len) == ESP_OK);
+    CHECK(memcmp(lcd->buffer, next, sizeof(next)) == 0);
+    pcd8544_flush(lcd);
+    pcd8544_sim_get_stats(TEST_CE_GPIO, &stats);
+    CHECK(test_panel_is_buffer(lcd, TEST_CE_GPIO));
+    CHECK(stats.data_bytes == 11);
+
+    // Truncated and overlong data
+    uint8_t truncated[] = {0x80 | 9, 1, 2, 3};
+    uint8_t overlong[]  = {0x40 | 63, 0, 0x40 | 63, 0, 0x40 | 63, 0,
+                           0x40 | 63, 0, 0x40 | 63, 0, 0x40 | 63, 0,
+                           0x40 | 63, 0, 0x40 | 63, 0};
+    CHECK(pcd8544_draw_rle(lcd, truncated, sizeof(truncated)) ==
+          ESP_ERR_INVALID_SIZE);
+    CHECK(pcd8544_draw_rle(lcd, overlong, sizeof(overlong)) ==
+          ESP_ERR_INVALID_SIZE);
+}
+
+// Wait for the player task to put a frame on the panel
+static bool test_anim_shows(pcd8544_handle_t* lcd, const uint8_t* frame) {
+    for (int i = 0; i < 500; i++) {
+        if (memcmp(pcd8544_sim_panel(TEST_CE_GPIO)->ram, frame,
+                   PCD8544_BUFFER_SIZE) == 0)
+            break;
+        vTaskDelay(1);
+    }
+    return memcmp(lcd->buffer, frame, PCD8544_BUFFER_SIZE) == 0 &&
+           test_panel_is_buffer(lcd, TEST_CE_GPIO);
+}
+
+static void test_anim(pcd8544_handle_t* lcd) {
+    static uint8_t       frames[3][PCD8544_BUFFER_SIZE];
+    static uint8_t       data[3][PCD8544_BUFFER_SIZE * 2];
+    pcd8544_anim_frame_t anim_frames[3];
+    pcd8544_anim_t       anim = {anim_frames, 3, true};
+
+    // A whole first frame, then deltas that change a band and a few bytes
+    for (size_t i = 0; i < PCD8544_BUFFER_SIZE; i++)
+        frames[0][i] = (i * 29) ^ (i >> 2);
+    memcpy(frames[1], frames[0], PCD8544_BUFFER_SIZE);
+    memset(&frames[1][90], 0x3C, 40);
+    memcpy(frames[2], frames[1], PCD8544_BUFFER_SIZE);
+    frames[2][0] ^= 0xFF;
+    memset(&frames[2][300], 0, 7);
+
+    for (size_t i = 0; i < 3; i++) {
+        anim_frames[i].data = data[i];
+        anim_frames[i].len =
+            test_rle_encode(frames[i], i ? frames[i - 1] : NULL, data[i]);
+        anim_frames[i].duration_ms = 10;
+    }
+
+    // Nothing is playing yet
+    CHECK(pcd8544_anim_pause(lcd) == ESP_ERR_INVALID_STATE);
+    CHECK(pcd8544_anim_seek(lcd, 0) == ESP_ERR_INVALID_STATE);
+    CHECK(pcd8544_anim_stop(lcd) == ESP_ERR_INVALID_STATE);
+    CHECK(pcd8544_anim_wait(lcd, 0) == ESP_OK);
+
+    // Played once, the last frame stays on the display
+    CHECK(pcd8544_anim_play(lcd, &anim, false) == ESP_OK);
+    CHECK(pcd8544_anim_wait(lcd, portMAX_DELAY) == ESP_OK);
+    CHECK(memcmp(lcd->buffer, frames[2], PCD8544_BUFFER_SIZE) == 0);
+    CHECK(test_panel_is_buffer(lcd, TEST_CE_GPIO));
+    CHECK(pcd8544_anim_resume(lcd) == ESP_ERR_INVALID_STATE);
+
+    // Frames long enough to stay until seeked away from. Seeking backwards
+    // rebuilds the frame from the first one.
+    for (size_t i = 0; i < 3; i++) anim_frames[i].duration_ms = 60000;
+
+    CHECK(pcd8544_anim_play(lcd, &anim, true) == ESP_OK);
+    CHECK(pcd8544_anim_play(lcd, &anim, true) == ESP_ERR_INVALID_STATE);
+    CHECK(test_anim_shows(lcd, frames[0]));
+    CHECK(pcd8544_anim_pause(lcd) == ESP_OK);
+    CHECK(pcd8544_anim_seek(lcd, 2) == ESP_OK);
+    CHECK(test_anim_shows(lcd, frames[2]));
+    CHECK(pcd8544_anim_seek(lcd, 1) == ESP_OK);
+    CHECK(test_anim_shows(lcd, frames[1]));
+    CHECK(pcd8544_anim_seek(lcd, 3) == ESP_ERR_INVALID_ARG);
+
+    // A running player seeks as well
+    CHECK(pcd8544_anim_resume(lcd) == ESP_OK);
+    CHECK(pcd8544_anim_seek(lcd, 2) == ESP_OK);
+    CHECK(test_anim_shows(lcd, frames[2]));
+
+    CHECK(pcd8544_anim_stop(lcd) == ESP_OK);
+    CHECK(pcd8544_anim_pause(lcd) == ESP_ERR_INVALID_STATE);
+    CHECK(memcmp(lcd->buffer, frames[2], PCD8544_BUFFER_SIZE) == 0);
+}
+
+static void test_dlist(pcd8544_handle_t* lcd) {
+    static const char text[] = "caf\xc3\xa9 \xe2\x82\xac" "1, \xff ok";
+    uint8_t           direct[PCD8544_BUFFER_SIZE];
+    pcd8544_dlist_t*  dlist;
+    uint8_t           x0, y0, x1, y1;
+
+    CHECK(pcd8544_dlist_create(256, &dlist) == ESP_OK);
+    if (!dlist) return;
+
+    // Text draws the same from a list as it does directly
+    pcd8544_goto_xy(lcd, 3, 9);
+    pcd8544_puts(lcd, PCD8544_FONT_5x7, PCD8544_PIXEL_BLACK, "%s", text);
+    memcpy(direct, lcd->buffer, PCD8544_BUFFER_SIZE);
+    pcd8544_clear(lcd);
+
+    CHECK(pcd8544_dlist_add_text(dlist, 3, 9, PCD8544_FONT_5x7,
+                                 PCD8544_PIXEL_BLACK, text) == ESP_OK);
+    CHECK(pcd8544_draw_dlist(lcd, dlist) == ESP_OK);
+    CHECK(memcmp(direct, lcd->buffer, PCD8544_BUFFER_SIZE) == 0);
+
+    // The area ends at the last glyph drawn: 10 characters have one
+    uint8_t expect_x1 = 3 + 9 * TEST_CHAR_WIDTH + TEST_CHAR_WIDTH - 2;
+    CHECK(pcd8544_dlist_get_area(dlist, &x0, &y0, &x1, &y1) == ESP_OK);
+    CHECK(x0 == 3 && y0 == 8 && x1 == expect_x1 && y1 == 23);
+
+    // A copy clears the spacing after the glyphs too, which the area covers
+    pcd8544_dlist_reset(dlist);
+    CHECK(pcd8544_dlist_add_text(dlist, 3, 9, PCD8544_FONT_5x7,
+                                 PCD8544_PIXEL_COPY, "ab") == ESP_OK);
+    CHECK(pcd8544_dlist_get_area(dlist, &x0, &y0, &x1, &y1) == ESP_OK);
+    CHECK(x0 == 3 && x1 == 3 + 2 * TEST_CHAR_WIDTH - 1);
+
+    pcd8544_dlist_delete(dlist);
+}
+
+// Draws the value of a template field as a number
+static void test_field_draw(pcd8544_handle_t* handle, const void* value,
+                            size_t len, void* user_ctx) {
+    pcd8544_goto_xy(handle, 40, 16);
+    pcd8544_puts(handle, PCD8544_FONT_5x7, PCD8544_PIXEL_BLACK, "%d",
+                 *(const int*)value);
+}
+
+static void test_template(pcd8544_handle_t* lcd) {
+    pcd8544_template_t* tmpl;
+    uint8_t             shown[PCD8544_BUFFER_SIZE];
+    int                 value = 12;
+
+    CHECK(pcd8544_template_create(1, &tmpl) == ESP_OK);
+    if (!tmpl) return;
+
+    pcd8544_draw_rectagle(lcd, 0, 0, 83, 47, PCD8544_PIXEL_BLACK, false);
+    pcd8544_template_capture(tmpl, lcd);
+    pcd8544_template_add_field(tmpl, 40, 16, 70, 23, test_field_draw, NULL,
+                               NULL);
+    pcd8544_template_set_field(tmpl, 0, &value, sizeof(value));
+
+    pcd8544_clear(lcd);
+    pcd8544_draw_template(lcd, tmpl);
+    pcd8544_flush(lcd);
+    memcpy(shown, lcd->buffer, PCD8544_BUFFER_SIZE);
+
+    // Unchanged fields are not drawn again
+    pcd8544_sim_stats_t stats;
+
+    pcd8544_sim_reset_stats(TEST_CE_GPIO);
+    pcd8544_draw_template(lcd, tmpl);
+    pcd8544_flush(lcd);
+    pcd8544_sim_get_stats(TEST_CE_GPIO, &stats);
+    CHECK(stats.transactions == 0);
+
+    // Another screen drawn over the template, then back to it: the whole
+    // template comes back, not only the fields
+    pcd8544_draw_rectagle(lcd, 0, 30, 83, 47, PCD8544_PIXEL_BLACK, true);
+    pcd8544_goto_xy(lcd, 0, 0);
+    pcd8544_puts(lcd, PCD8544_FONT_5x7, PCD8544_PIXEL_BLACK, "Menu");
+    pcd8544_draw_template(lcd, tmpl);
+    CHECK(memcmp(shown, lcd->buffer, PCD8544_BUFFER_SIZE) == 0);
+
+    // A changed field is restored and drawn again
+    value = 7;
+    pcd8544_template_set_field(tmpl, 0, &value, sizeof(value));
+    pcd8544_draw_template(lcd, tmpl);
+    pcd8544_flush(lcd);
+    CHECK(test_panel_is_buffer(lcd, TEST_CE_GPIO));
+    CHECK(pcd8544_sim_get_pixel(TEST_CE_GPIO, 0, 0));
+    CHECK(!pcd8544_sim_get_pixel(TEST_CE_GPIO, 10, 40));
+
+    pcd8544_template_delete(tmpl);
+}
+
+typedef struct {
+    char   text[512];
+    size_t len;
+} test_text_t;
+
+static void test_emit(void* ctx, const char* str, size_t len) {
+    test_text_t* text = ctx;
+
+    if (text->len + len >= sizeof(text->text)) return;
+    memcpy(&text->text[text->len], str, len);
+    text->len += len;
+    text->text[text->len] = 0;
+}
+
+// Whether the formatter turns the arguments into expect
+static bool test_format_is(const char* expect, const char* format, ...) {
+    test_text_t text = {.len = 0};
+    va_list     arg;
+
+    text.text[0] = 0;
+    va_start(arg, format);
+    pcd8544_format(test_emit, &text, format, arg);
+    va_end(arg);
+
+    if (strcmp(text.text, expect) == 0) return true;
+    printf("format \"%s\": \"%s\", expected \"%s\"\n", format, text.text,
+           expect);
+    return false;
+}
+
+static void test_format(pcd8544_handle_t* lcd) {
+    CHECK(test_format_is("plain text", "plain text"));
+    CHECK(test_format_is("42 -7 +3  5", "%d %i %+d % d", 42, -7, 3, 5));
+    CHECK(test_format_is("[   42][42   ][00042]", "[%5d][%-5d][%05d]", 42, 42,
+                         42));
+    CHECK(test_format_is("-0042 00042", "%05d %.5d", -42, 42));
+    CHECK(test_format_is("ff FF 0xff 17 017", "%x %X %#x %o %#o", 255, 255,
+                         255, 15, 15));
+    CHECK(test_format_is("-1 4294967295 18446744073709551615", "%ld %u %llu",
+                         -1L, 4294967295u, 18446744073709551615ull));
+    CHECK(test_format_is("-128 255 -1", "%hhd %hhu %hd", -128, 255, 65535));
+    CHECK(test_format_is("12 -9223372036854775808", "%zu %lld", (size_t)12,
+                         (long long)(-9223372036854775807LL - 1)));
+    CHECK(test_format_is("[  abc][ab][(null)]", "[%5s][%.2s][%s]", "abc",
+                         "abcdef", (const char*)NULL));
+    CHECK(test_format_is("x% [   7]", "%c%% [%*d]", 'x', 4, 7));
+    CHECK(test_format_is("3.141593 3.14 -2.50 +1", "%f %.2f %.2f %+.0f",
+                         3.1415926, 3.1415926, -2.5, 1.0));
+    CHECK(test_format_is("0.999 1.000 10", "%.3f %.3f %.0f", 0.999, 0.9999,
+                         9.5));
+    CHECK(test_format_is("  nan inf", "%5f %f", NAN, INFINITY));
+    CHECK(test_format_is("-0.0 -0", "%.1f %.0f", -0.0, -0.0));
+    CHECK(test_format_is("10000000000000000000.0 -18446744073709551616",
+                         "%.1f %.0f", 1e19, -18446744073709551616.0));
+    CHECK(test_format_is("[ 100000000000000000000 ]", "[%22.0f ]", 1e20));
+    CHECK(test_format_is("123456789012345677877719597056", "%.0f",
+                         123456789012345678901234567890.0));
+    CHECK(test_format_is("1797693134862315708145274237317043567980705675258"
+                         "449965989174768031572607800285387605895586327668781"
+                         "715404589535143824642343213268894641827684675467035"
+                         "375169860499105765512820762454900903893289440758685"
+                         "084551339423045832369032229481658085593321233482747"
+                         "978262041447231687381771809192998812504040261841248"
+                         "58368",
+                         "%.0f", 1.7976931348623157e308));
+    CHECK(test_format_is("2.50 1.5", "%.2Lf %.1f", 2.5L, 1.5));
+    CHECK(test_format_is("%e 7 %g 8 %Le 9", "%e %d %g %d %Le %d", 1.0, 7, 2.0,
+                         8, 3.0L, 9));
+
+    // Numbers without a format string
+    pcd8544_goto_xy(lcd, 0, 0);
+    CHECK(pcd8544_put_fixed(lcd, &pcd8544_font_5x7, PCD8544_PIXEL_BLACK, -1234,
+                            2, 7, '0') == ESP_OK);
+    CHECK(lcd->_x == 7 * TEST_CHAR_WIDTH);
+}
+
+// Lines of 5x7 text copied into their rows from y down over a blank screen
+// with two marks outside of the console, what a console should show
+static void test_console_expect(pcd8544_handle_t* lcd, uint8_t y,
+                                const char* const* lines, size_t n,
+                                uint8_t* expect) {
+    pcd8544_clear(lcd);
+    pcd8544_draw_line(lcd, 0, 2, 83, 2, PCD8544_PIXEL_BLACK);
+    pcd8544_draw_line(lcd, 0, 40, 83, 40, PCD8544_PIXEL_BLACK);
+    for (size_t i = 0; i < n; i++) {
+        pcd8544_goto_xy(lcd, 0, y + i * 8);
+        pcd8544_puts(lcd, PCD8544_FONT_5x7, PCD8544_PIXEL_COPY, "%s", lines[i]);
+    }
+    memcpy(expect, lcd->buffer, PCD8544_BUFFER_SIZE);
+    pcd8544_clear(lcd);
+    pcd8544_draw_line(lcd, 0, 2, 83, 2, PCD8544_PIXEL_BLACK);
+    pcd8544_draw_line(lcd, 0, 40, 83, 40, PCD8544_PIXEL_BLACK);
+}
+
+static void test_console(pcd8544_handle_t* lcd) {
+    static const char* const wrapped[]  = {"0123456789ABCD", "EFG"};
+    static const char* const scrolled[] = {"line2", "line3", "x"};
+    static const char* const cleared[]  = {"zz"};
+    pcd8544_console_config_t config     = {PCD8544_FONT_5x7, 8, 3};
+    pcd8544_console_t*       console;
+    uint8_t                  expect[PCD8544_BUFFER_SIZE];
+
+    // 14 characters fit on a row, the rest wraps to the next one
+    test_console_expect(lcd, 8, wrapped, 2, expect);
+    CHECK(pcd8544_console_create(lcd, &config, &console) == ESP_OK);
+    if (!console) return;
+    CHECK(pcd8544_console_write(console, "0123456789ABCDEFG") == ESP_OK);
+    CHECK(memcmp(lcd->buffer, expect, PCD8544_BUFFER_SIZE) == 0);
+
+    // Past the third row the older rows move up, the rows around stay
+    test_console_expect(lcd, 8, scrolled, 3, expect);
+    pcd8544_console_clear(console);
+    CHECK(pcd8544_console_write(console, "0123456789ABCDEFG\nline2\n") ==
+          ESP_OK);
+    CHECK(pcd8544_console_printf(console, "line%d\nx", 3) == ESP_OK);
+    CHECK(memcmp(lcd->buffer, expect, PCD8544_BUFFER_SIZE) == 0);
+
+    // A redraw draws the same from the text ring
+    pcd8544_fill_area(lcd, 0, 8, 83, 31, PCD8544_PIXEL_BLACK);
+    CHECK(pcd8544_console_redraw(console) == ESP_OK);
+    CHECK(memcmp(lcd->buffer, expect, PCD8544_BUFFER_SIZE) == 0);
+
+    // In terminal mode characters go straight to the panel, a scroll or clear
+    // before them is sent first
+    pcd8544_flush(lcd);
+    pcd8544_set_terminal_mode(lcd, true);
+    for (int i = 0; i < 5; i++) {
+        pcd8544_console_printf(console, "\nrow %d", i);
+        CHECK(test_panel_is_buffer(lcd, TEST_CE_GPIO));
+    }
+    test_console_expect(lcd, 8, cleared, 1, expect);
+    pcd8544_console_clear(console);
+    pcd8544_console_write(console, "zz");
+    CHECK(memcmp(lcd->buffer, expect, PCD8544_BUFFER_SIZE) == 0);
+    CHECK(test_panel_is_buffer(lcd, TEST_CE_GPIO));
+    pcd8544_set_terminal_mode(lcd, false);
+
+    // Rows that do not fit
+    config.rows = 6;
+    CHECK(pcd8544_console_create(lcd, &config, &console) ==
+          ESP_ERR_INVALID_ARG);
+
+    pcd8544_console_delete(console);
+}
+
+static const struct {
+    const char* name;
+    test_fn_t   fn;
+} s_tests[] = {
+    {"flush", test_flush},
+    {"flush_error", test_flush_error},
+    {"flush_async", test_flush_async},
+    {"flush_multi", test_flush_multi},
+    {"scroll", test_scroll},
+    {"scroll_smooth", test_scroll_smooth},
+    {"render_task", test_render_task},
+    {"terminal_mode", test_terminal_mode},
+    {"concurrent_flush", test_concurrent_flush},
+    {"fonts", test_fonts},
+    {"utf8", test_utf8},
+    {"text_box", test_text_box},
+    {"xor", test_xor},
+    {"blit", test_blit},
+    {"rle", test_rle},
+    {"anim", test_anim},
+    {"dlist", test_dlist},
+    {"template", test_template},
+    {"format", test_format},
+    {"console", test_console},
+};
+
+int main(void) {
+    pcd8544_handle_t* lcd = test_init(TEST_CE_GPIO);
+
+    if (!lcd) {
+        printf("init failed\n");
+        return 1;
+    }
+
+    for (size_t i = 0; i < sizeof(s_tests) / sizeof(s_tests[0]); i++) {
+        int failures = s_failures;
+
+        pcd8544_clear(lcd);
+        pcd8544_flush(lcd);
+        s_tests[i].fn(lcd);
+        printf("%-20s %s\n", s_tests[i].name,
+               s_failures == failures ? "ok" : "FAILED");
+    }
+
+    pcd8544_deinit(lcd);
+    return s_failures ? 1 : 0;
+}
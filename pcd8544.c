@@ -1,83 +1,382 @@
 #include "pcd8544.h"
 
+#include <stdlib.h>
 #include <string.h>
 
 #include "driver/gpio.h"
-#include "driver/ledc.h"
-#include "driver/spi_master.h"
+#include "esp_heap_caps.h"
 #include "esp_log.h"
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
+#include "esp_timer.h"
 #include "pcd8544_fonts.h"
+#include "pcd8544_priv.h"
 #include "sys/param.h"
 
 static const char* TAG = "pcd8544";
 
+// Cost of starting a new run, in byte times: the two address commands plus
+// the overhead of one more command and one more data transaction. Unchanged
+// gaps up to this length are cheaper to stream than to jump over.
+#define PCD8544_READDRESS_COST  (2 + 2 * CONFIG_PCD8544_TRANS_OVERHEAD_BYTES)
+
+// Smooth scroll animation task
+#define PCD8544_SCROLL_TASK_STACK 2048
+#define PCD8544_SCROLL_TASK_PRIO  5
+// Render task and its event bits. The vsync bits alternate between frames, so
+// a waiter can tell the next frame from the one that has already passed.
+#define PCD8544_RENDER_TASK_STACK 2048
+#define PCD8544_RENDER_TASK_PRIO  5
+#define PCD8544_RENDER_VSYNC_EVEN (1 << 0)
+#define PCD8544_RENDER_VSYNC_ODD  (1 << 1)
+#define PCD8544_RENDER_STOPPED    (1 << 2)
+
+// Code point malformed UTF-8 decodes to
+#define PCD8544_UTF8_INVALID 0xFFFD
+
+// A run of display RAM to be sent, starting at bank / x
 typedef struct {
-    uint8_t                buffer[PCD8544_BUFFER_SIZE];
-    uint8_t                update_xmin;
-    uint8_t                update_xmax;
-    uint8_t                update_ymin;
-    uint8_t                update_ymax;
-    uint8_t                _x;
-    uint8_t                _y;
-    bool                   is_inverted;
-    ledc_channel_config_t* backlight_pwm;
-    pcd8544_io_config_t*   io;
-    spi_device_handle_t    spi_handle;
-} pcd8544_handle_t;
-
-static pcd8544_handle_t* g_handle = NULL;
+    uint8_t  bank;
+    uint8_t  x;
+    uint16_t len;
+} pcd8544_span_t;
+
+// Backlight LEDC channels in use, one per display
+static uint8_t s_ledc_channels = 0;
 
 // This function is called (in irq context!) just before a transmission starts.
-// It will set the D/C line to the value indicated in the user field.
+// It will set the D/C line of the device to the level in the user field.
 static void lcd_spi_pre_transfer_callback(spi_transaction_t* t) {
-    int dc = (int)t->user;
-    gpio_set_level(g_handle->io->dc_gpio_num, dc);
+    pcd8544_trans_ctx_t* ctx = t->user;
+    gpio_set_level(ctx->handle->io->dc_gpio_num, ctx->dc);
+}
+
+// This function is called (in irq context!) when a transmission is done.
+// It will notify the async flush caller once its last transaction is out.
+static void lcd_spi_post_transfer_callback(spi_transaction_t* t) {
+    pcd8544_handle_t* handle = ((pcd8544_trans_ctx_t*)t->user)->handle;
+
+    if (t == handle->async_last && handle->async_cb)
+        handle->async_cb(handle->async_cb_ctx);
+}
+
+// Collect the results of all queued transactions. Polling transactions can not
+// be sent on the device until this is done.
+static esp_err_t pcd8544_async_reap(pcd8544_handle_t* handle,
+                                    TickType_t        ticks_to_wait) {
+    spi_transaction_t* t;
+
+    while (handle->async_queued) {
+        if (spi_device_get_trans_result(handle->spi_handle, &t,
+                                        ticks_to_wait) != ESP_OK)
+            return ESP_ERR_TIMEOUT;
+        handle->async_queued--;
+    }
+
+    return ESP_OK;
+}
+
+static void pcd8544_prepare_trans(pcd8544_handle_t*  handle,
+                                  spi_transaction_t* t, const uint8_t* bytes,
+                                  size_t len, int dc) {
+    memset(t, 0, sizeof(spi_transaction_t));
+    t->length = len * 8;  // Length is in bits
+    t->user   = dc ? &handle->data_ctx : &handle->cmd_ctx;
+
+    if (len <= 4) {
+        // Short transfers (commands) go through the transaction itself
+        t->flags = SPI_TRANS_USE_TXDATA;
+        memcpy(t->tx_data, bytes, len);
+    } else {
+        t->tx_buffer = bytes;
+    }
+
+    handle->stats.transactions++;
+    if (dc)
+        handle->stats.data_bytes += len;
+    else
+        handle->stats.cmd_bytes += len;
+}
+
+static esp_err_t pcd8544_send(pcd8544_handle_t* handle, const uint8_t* bytes,
+                              size_t len, int dc) {
+    spi_transaction_t t;
+    esp_err_t         ret = pcd8544_async_reap(handle, portMAX_DELAY);
+
+    if (ret != ESP_OK) return ret;
+    pcd8544_prepare_trans(handle, &t, bytes, len, dc);
+    return spi_device_polling_transmit(handle->spi_handle, &t);
+}
+
+static esp_err_t pcd8544_queue(pcd8544_handle_t* handle, const uint8_t* bytes,
+                               size_t len, int dc) {
+    spi_transaction_t* t = &handle->async_trans[handle->async_queued];
+
+    pcd8544_prepare_trans(handle, t, bytes, len, dc);
+    esp_err_t ret = spi_device_queue_trans(handle->spi_handle, t, portMAX_DELAY);
+    if (ret == ESP_OK) handle->async_queued++;
+    return ret;
+}
+
+static esp_err_t pcd8544_send_cmds(pcd8544_handle_t* handle,
+                                   const uint8_t* cmds, size_t len) {
+    return pcd8544_send(handle, cmds, len, 0);  // D/C needs to be set to 0
+}
+
+static esp_err_t pcd8544_send_data(pcd8544_handle_t* handle,
+                                   const uint8_t* data, size_t len) {
+    return pcd8544_send(handle, data, len, 1);  // D/C needs to be set to 1
+}
+
+static esp_err_t pcd8544_send_cmd(pcd8544_handle_t* handle, uint8_t cmd) {
+    return pcd8544_send_cmds(handle, &cmd, 1);
+}
+
+// Write a run of display RAM starting at bank / x, either right away or by
+// queueing it on the device
+static esp_err_t pcd8544_write_ram(pcd8544_handle_t* handle, uint8_t bank,
+                                   uint8_t x, const uint8_t* data, size_t len,
+                                   bool async) {
+    uint8_t   cmds[] = {PCD8544_SETYADDR | bank, PCD8544_SETXADDR | x};
+    esp_err_t ret;
+
+    if (async) {
+        ret = pcd8544_queue(handle, cmds, sizeof(cmds), 0);
+        if (ret == ESP_OK) ret = pcd8544_queue(handle, data, len, 1);
+    } else {
+        ret = pcd8544_send_cmds(handle, cmds, sizeof(cmds));
+        if (ret == ESP_OK) ret = pcd8544_send_data(handle, data, len);
+    }
+
+    // The address counter wraps to the next bank, and from the last byte back
+    // to the first. Where it stopped after an error is not known.
+    handle->ram_next =
+        ret == ESP_OK
+            ? (bank * PCD8544_H_RES_MAX + x + len) % PCD8544_BUFFER_SIZE
+            : UINT16_MAX;
+    return ret;
+}
+
+// Widen the dirty column span of every bank the area touches. Every drawing
+// comes through here, so the buffer no longer holds just the template it was
+// restored from; pcd8544_draw_template() sets it again after its own drawing.
+void pcd8544_update_area(pcd8544_handle_t* handle, uint8_t xMin, uint8_t yMin,
+                         uint8_t xMax, uint8_t yMax) {
+    handle->shown_template = NULL;
+    for (uint8_t i = yMin / 8; i <= yMax / 8; i++) {
+        handle->dirty_xmin[i] = MIN(xMin, handle->dirty_xmin[i]);
+        handle->dirty_xmax[i] = MAX(xMax, handle->dirty_xmax[i]);
+    }
+}
+
+// Sort the corners of an area and clip it to the display. Returns false when
+// nothing of it is visible.
+bool pcd8544_clip_area(uint8_t* x0, uint8_t* y0, uint8_t* x1, uint8_t* y1) {
+    uint8_t temp;
+
+    if (*x0 > *x1) {
+        temp = *x1;
+        *x1  = *x0;
+        *x0  = temp;
+    }
+
+    if (*y0 > *y1) {
+        temp = *y1;
+        *y1  = *y0;
+        *y0  = temp;
+    }
+
+    if (*x0 >= PCD8544_H_RES_MAX || *y0 >= PCD8544_V_RES_MAX) return false;
+
+    *x1 = MIN(*x1, PCD8544_H_RES_MAX - 1);
+    *y1 = MIN(*y1, PCD8544_V_RES_MAX - 1);
+    return true;
+}
+
+// Fill a clipped area a byte at a time: every bank it covers gets one mask for
+// the rows inside the area, which is then applied to each column. The caller
+// updates the dirty area.
+void pcd8544_fill_span(pcd8544_handle_t* handle, uint8_t x0, uint8_t y0,
+                       uint8_t x1, uint8_t y1, pcd8544_pixel_color_t color) {
+    for (uint8_t i = y0 / 8; i <= y1 / 8; i++) {
+        uint8_t  mask = 0xFF;
+        uint8_t* p    = &handle->buffer[i * PCD8544_H_RES_MAX + x0];
+
+        if (i == y0 / 8) mask &= 0xFF << (y0 % 8);
+        if (i == y1 / 8) mask &= 0xFF >> (7 - (y1 % 8));
+
+        if (color == PCD8544_PIXEL_WHITE) {
+            mask = ~mask;
+            for (uint8_t x = x0; x <= x1; x++) *p++ &= mask;
+        } else if (color == PCD8544_PIXEL_XOR) {
+            for (uint8_t x = x0; x <= x1; x++) *p++ ^= mask;
+        } else {
+            for (uint8_t x = x0; x <= x1; x++) *p++ |= mask;
+        }
+    }
+}
+
+void pcd8544_fill_area(pcd8544_handle_t* handle, uint8_t x0, uint8_t y0,
+                       uint8_t x1, uint8_t y1, pcd8544_pixel_color_t color) {
+    if (!pcd8544_clip_area(&x0, &y0, &x1, &y1)) return;
+
+    pcd8544_fill_span(handle, x0, y0, x1, y1, color);
+    pcd8544_update_area(handle, x0, y0, x1, y1);
 }
 
-static void pcd8544_send_cmd(uint8_t cmd) {
-    spi_transaction_t t = {0};
-    t.length            = 8;         // Command is 8 bits
-    t.tx_buffer         = &cmd;      // Command
-    t.user              = (void*)0;  // D/C needs to be set to 0
-    spi_device_polling_transmit(g_handle->spi_handle, &t);
+// Draw the set bits of a column byte (bit 0 on top) with its top row at y.
+// The byte lands in at most two banks; its bits are shifted into place and
+// applied to each bank as a whole. The caller updates the dirty area.
+void pcd8544_blit_byte(pcd8544_handle_t* handle, uint8_t x, uint8_t y,
+                       uint8_t bits, uint8_t area,
+                       pcd8544_pixel_color_t color) {
+    if (x >= PCD8544_H_RES_MAX || y >= PCD8544_V_RES_MAX) return;
+
+    uint8_t* p     = &handle->buffer[(y / 8) * PCD8544_H_RES_MAX + x];
+    uint8_t  shift = y % 8;
+
+    bits &= area;
+    pcd8544_rop(&p[0], bits << shift, area << shift, color);
+    if (shift && area >> (8 - shift) && (y / 8) + 1 < PCD8544_BANK_NUM)
+        pcd8544_rop(&p[PCD8544_H_RES_MAX], bits >> (8 - shift),
+                    area >> (8 - shift), color);
 }
 
-static void pcd8544_send_data(uint8_t data) {
-    spi_transaction_t t = {0};
-    t.length            = 8;         // Data is 8 bits
-    t.tx_buffer         = &data;     // Data
-    t.user              = (void*)1;  // D/C needs to be set to 1
-    spi_device_polling_transmit(g_handle->spi_handle, &t);
+// Rows of a column byte drawn when rows rows are left, see pcd8544_rop()
+static uint8_t pcd8544_area_rows(uint8_t rows) {
+    return rows >= 8 ? 0xFF : (1 << rows) - 1;
 }
 
-static void pcd8544_update_area(uint8_t xMin, uint8_t yMin, uint8_t xMax,
-                                uint8_t yMax) {
-    g_handle->update_xmin = MIN(xMin, g_handle->update_xmin);
-    g_handle->update_ymin = MIN(yMin, g_handle->update_ymin);
-    g_handle->update_xmax = MAX(xMax, g_handle->update_xmax);
-    g_handle->update_ymax = MAX(yMax, g_handle->update_ymax);
+static void pcd8544_mark_clean(pcd8544_handle_t* handle) {
+    memset(handle->dirty_xmin, PCD8544_H_RES_MAX - 1,
+           sizeof(handle->dirty_xmin));
+    memset(handle->dirty_xmax, 0, sizeof(handle->dirty_xmax));
 }
 
-esp_err_t pcd8544_reset(void) {
-    if (!g_handle) return ESP_ERR_INVALID_STATE;
+// Turn the dirty spans into runs of bytes that differ from the shadow, copy
+// them into the shadow and mark everything clean. Runs are kept in buffer
+// offsets: the controller wraps to the next bank by itself, so a run can go
+// across a bank boundary. Called with both locks held and no async flush in
+// flight; the changes are snapshotted into the shadow and sent from there, so
+// drawing can go on once lock is released.
+static uint8_t pcd8544_plan_flush(pcd8544_handle_t* handle,
+                                  pcd8544_span_t    spans[PCD8544_SPAN_MAX]) {
+    uint8_t  n     = 0;
+    uint16_t start = 0, end = 0;
+    bool     open  = false;
+
+    // Nothing is known of the controller RAM before the first flush and after
+    // a failed transfer, the whole buffer is sent
+    if (!handle->shadow_valid) {
+        memset(handle->dirty_xmin, 0, sizeof(handle->dirty_xmin));
+        memset(handle->dirty_xmax, PCD8544_H_RES_MAX - 1,
+               sizeof(handle->dirty_xmax));
+    }
+
+    for (uint8_t i = 0; i < PCD8544_BANK_NUM; i++) {
+        if (handle->dirty_xmin[i] > handle->dirty_xmax[i]) continue;
+
+        uint16_t base = i * PCD8544_H_RES_MAX;
+        for (uint16_t off = base + handle->dirty_xmin[i];
+             off <= base + handle->dirty_xmax[i]; off++) {
+            if (handle->shadow_valid &&
+                handle->buffer[off] == handle->shadow[off])
+                continue;
+
+            if (open && (off - end - 1 <= PCD8544_READDRESS_COST ||
+                         n == PCD8544_SPAN_MAX - 1)) {
+                end = off;
+                continue;
+            }
+
+            if (open) {
+                spans[n].bank = start / PCD8544_H_RES_MAX;
+                spans[n].x    = start % PCD8544_H_RES_MAX;
+                spans[n].len  = end - start + 1;
+                n++;
+            }
+            start = end = off;
+            open        = true;
+        }
+    }
+
+    if (open) {
+        spans[n].bank = start / PCD8544_H_RES_MAX;
+        spans[n].x    = start % PCD8544_H_RES_MAX;
+        spans[n].len  = end - start + 1;
+        n++;
+    }
+
+    // Bytes streamed over an unchanged gap are equal in both buffers
+    for (uint8_t i = 0; i < n; i++) {
+        uint16_t offset = spans[i].bank * PCD8544_H_RES_MAX + spans[i].x;
+        memcpy(&handle->shadow[offset], &handle->buffer[offset],
+               spans[i].len);
+    }
+
+    // The shadow holds what the controller shows once the runs are sent,
+    // pcd8544_flush_spans() clears this again if they are not
+    handle->shadow_valid = true;
+
+    pcd8544_mark_clean(handle);
+    return n;
+}
 
-    gpio_set_level(g_handle->io->rst_gpio_num,
-                   g_handle->io->flags.rst_active_high);
+static void pcd8544_reset(pcd8544_handle_t* handle) {
+    gpio_set_level(handle->io->rst_gpio_num,
+                   handle->io->flags.rst_active_high);
     vTaskDelay(pdMS_TO_TICKS(100));
-    gpio_set_level(g_handle->io->rst_gpio_num,
-                   1 - g_handle->io->flags.rst_active_high);
+    gpio_set_level(handle->io->rst_gpio_num,
+                   1 - handle->io->flags.rst_active_high);
     vTaskDelay(pdMS_TO_TICKS(100));
+}
 
-    return ESP_OK;
+static void pcd8544_backlight_init(pcd8544_handle_t*          handle,
+                                   const pcd8544_io_config_t* io_config) {
+    uint8_t channel = 0;
+
+    // Every display gets its own channel on the shared timer
+    while (channel < LEDC_CHANNEL_MAX && (s_ledc_channels & (1 << channel)))
+        channel++;
+
+    if (channel == LEDC_CHANNEL_MAX) {
+        ESP_LOGW(TAG, "No free LEDC channel, backlight is not used");
+        return;
+    }
+
+    if (!s_ledc_channels) {
+        ledc_timer_config_t ledc_timer = {
+            .duty_resolution = LEDC_TIMER_13_BIT,     // resolution of PWM duty
+            .freq_hz         = 5000,                  // frequency of PWM signal
+            .speed_mode      = LEDC_HIGH_SPEED_MODE,  // timer mode
+            .timer_num       = LEDC_TIMER_0,          // timer index
+            .clk_cfg         = LEDC_AUTO_CLK,  // Auto select the source clock
+        };
+        // Set configuration of timer0 for high speed channels
+        ledc_timer_config(&ledc_timer);
+
+        // Initialize fade service
+        ledc_fade_func_install(0);
+    }
+
+    s_ledc_channels |= 1 << channel;
+
+    handle->backlight_pwm = calloc(1, sizeof(ledc_channel_config_t));
+    handle->backlight_pwm->channel    = channel;
+    handle->backlight_pwm->duty       = 0;
+    handle->backlight_pwm->gpio_num   = io_config->bkl_gpio_num;
+    handle->backlight_pwm->speed_mode = LEDC_HIGH_SPEED_MODE;
+    handle->backlight_pwm->hpoint     = 0;
+    handle->backlight_pwm->timer_sel  = LEDC_TIMER_0;
+    handle->backlight_pwm->flags.output_invert =
+        1 - io_config->flags.bkl_active_high;
+
+    // Set LED Controller with previously prepared configuration
+    ledc_channel_config(handle->backlight_pwm);
 }
 
 esp_err_t pcd8544_init(const spi_host_device_t    spi_host,
-                       const pcd8544_io_config_t* io_config) {
-    if (g_handle) return ESP_ERR_INVALID_STATE;
-
-    if (!io_config) return ESP_ERR_INVALID_ARG;
+                       const pcd8544_io_config_t* io_config,
+                       pcd8544_handle_t**         ret_handle) {
+    if (!io_config || !ret_handle) return ESP_ERR_INVALID_ARG;
 
     if (io_config->rst_gpio_num == -1) {
         ESP_LOGW(TAG, "Invalid RST gpio number");
@@ -94,285 +393,1045 @@ esp_err_t pcd8544_init(const spi_host_device_t    spi_host,
         return ESP_ERR_INVALID_ARG;
     }
 
-    g_handle = calloc(1, sizeof(pcd8544_handle_t));
-    memset(g_handle, 0, sizeof(pcd8544_handle_t));
-    g_handle->io = calloc(1, sizeof(pcd8544_io_config_t));
-    memcpy(g_handle->io, io_config, sizeof(pcd8544_io_config_t));
+    // The frame buffer is sent straight from the handle, keep it DMA capable
+    pcd8544_handle_t* handle =
+        heap_caps_calloc(1, sizeof(pcd8544_handle_t), MALLOC_CAP_DMA);
+    if (!handle) return ESP_ERR_NO_MEM;
+    pcd8544_mark_clean(handle);
+    handle->ram_next = UINT16_MAX;
+    handle->shadow    = heap_caps_malloc(PCD8544_BUFFER_SIZE, MALLOC_CAP_DMA);
+    handle->lock      = xSemaphoreCreateRecursiveMutex();
+    handle->xfer_lock = xSemaphoreCreateMutex();
+    if (!handle->shadow || !handle->lock || !handle->xfer_lock) {
+        if (handle->lock) vSemaphoreDelete(handle->lock);
+        if (handle->xfer_lock) vSemaphoreDelete(handle->xfer_lock);
+        free(handle->shadow);
+        free(handle);
+        return ESP_ERR_NO_MEM;
+    }
+    handle->io = calloc(1, sizeof(pcd8544_io_config_t));
+    memcpy(handle->io, io_config, sizeof(pcd8544_io_config_t));
+
+    handle->cmd_ctx.handle  = handle;
+    handle->cmd_ctx.dc      = 0;
+    handle->data_ctx.handle = handle;
+    handle->data_ctx.dc     = 1;
 
     spi_device_interface_config_t devcfg = {
         .clock_speed_hz = 4 * 1000 * 1000,         // Clock 4MHz
         .mode           = 0,                       // SPI mode 0
         .spics_io_num   = io_config->ce_gpio_num,  // CE pin
-        .queue_size     = 10,  // Queue 10 transactions at a time
+        .queue_size     = PCD8544_ASYNC_TRANS_MAX,  // Room for a whole
+                                                    // async flush
         .pre_cb = lcd_spi_pre_transfer_callback,  // Specify pre-transfer
                                                   // callback to handle D/C line
+        .post_cb = lcd_spi_post_transfer_callback,  // Signal async flush done
     };
 
-    spi_bus_add_device(spi_host, &devcfg, &g_handle->spi_handle);
+    esp_err_t ret = spi_bus_add_device(spi_host, &devcfg, &handle->spi_handle);
+    if (ret != ESP_OK) {
+        vSemaphoreDelete(handle->lock);
+        vSemaphoreDelete(handle->xfer_lock);
+        free(handle->io);
+        free(handle->shadow);
+        free(handle);
+        return ret;
+    }
+
     gpio_set_direction(io_config->rst_gpio_num, GPIO_MODE_OUTPUT);
     gpio_set_direction(io_config->dc_gpio_num, GPIO_MODE_OUTPUT);
 
     if (io_config->bkl_gpio_num != -1) {
-        ledc_timer_config_t ledc_timer = {
-            .duty_resolution = LEDC_TIMER_13_BIT,     // resolution of PWM duty
-            .freq_hz         = 5000,                  // frequency of PWM signal
-            .speed_mode      = LEDC_HIGH_SPEED_MODE,  // timer mode
-            .timer_num       = LEDC_TIMER_0,          // timer index
-            .clk_cfg         = LEDC_AUTO_CLK,  // Auto select the source clock
-        };
-        // Set configuration of timer0 for high speed channels
-        ledc_timer_config(&ledc_timer);
-
-        g_handle->backlight_pwm = calloc(1, sizeof(ledc_channel_config_t));
-        g_handle->backlight_pwm->channel    = LEDC_CHANNEL_0;
-        g_handle->backlight_pwm->duty       = 0;
-        g_handle->backlight_pwm->gpio_num   = io_config->bkl_gpio_num;
-        g_handle->backlight_pwm->speed_mode = LEDC_HIGH_SPEED_MODE;
-        g_handle->backlight_pwm->hpoint     = 0;
-        g_handle->backlight_pwm->timer_sel  = LEDC_TIMER_0;
-        g_handle->backlight_pwm->flags.output_invert =
-            1 - io_config->flags.bkl_active_high;
-
-        // Set LED Controller with previously prepared configuration
-        ledc_channel_config(g_handle->backlight_pwm);
-
-        // Initialize fade service
-        ledc_fade_func_install(0);
-
+        pcd8544_backlight_init(handle, io_config);
     } else {
         ESP_LOGW(TAG, "Backlight is not used");
     }
 
     // Reset LCD
-    pcd8544_reset();
+    pcd8544_reset(handle);
 
     // Go in extended mode
-    pcd8544_send_cmd(PCD8544_FUNCTIONSET | PCD8544_EXTENDEDINSTRUCTION);
+    pcd8544_send_cmd(handle, PCD8544_FUNCTIONSET | PCD8544_EXTENDEDINSTRUCTION);
 
     // LCD bias select
-    pcd8544_send_cmd(PCD8544_SETBIAS | CONFIG_PCD8544_LCD_BIAS);
+    pcd8544_send_cmd(handle, PCD8544_SETBIAS | CONFIG_PCD8544_LCD_BIAS);
 
     // Set temperature
-    pcd8544_send_cmd(PCD8544_SETTEMP | CONFIG_PCD8544_LCD_TEMP);
+    pcd8544_send_cmd(handle, PCD8544_SETTEMP | CONFIG_PCD8544_LCD_TEMP);
 
     // Set VOP
-    pcd8544_send_cmd(PCD8544_SETVOP | CONFIG_PCD8544_LCD_CONTRAST);
+    pcd8544_send_cmd(handle, PCD8544_SETVOP | CONFIG_PCD8544_LCD_CONTRAST);
 
     // Normal mode
-    pcd8544_send_cmd(PCD8544_FUNCTIONSET);
+    pcd8544_send_cmd(handle, PCD8544_FUNCTIONSET);
 
     // Set display to Normal
-    pcd8544_send_cmd(PCD8544_DISPLAYCONTROL | PCD8544_DISPLAYNORMAL);
+    pcd8544_send_cmd(handle, PCD8544_DISPLAYCONTROL | PCD8544_DISPLAYNORMAL);
 
-    // Clear display
-    pcd8544_clear();
+    // Clear display, the RAM content is unknown after reset
+    pcd8544_clear(handle);
+    pcd8544_flush(handle);
+
+    *ret_handle = handle;
 
     ESP_LOGI(TAG, "Successfully initialized");
     return ESP_OK;
 }
 
-esp_err_t pcd8544_deinit(void) {
-    if (!g_handle) return ESP_ERR_INVALID_STATE;
+esp_err_t pcd8544_deinit(pcd8544_handle_t* handle) {
+    if (!handle) return ESP_ERR_INVALID_ARG;
+
+    // Let an animation, a smooth scroll, the render task and an async flush
+    // finish before the device goes away
+    if (handle->anim_idle) {
+        pcd8544_anim_stop(handle);
+        xSemaphoreTake(handle->anim_idle, portMAX_DELAY);
+        vSemaphoreDelete(handle->anim_idle);
+    }
+    if (handle->scroll_idle) {
+        xSemaphoreTake(handle->scroll_idle, portMAX_DELAY);
+        vSemaphoreDelete(handle->scroll_idle);
+    }
+    if (handle->render_task) pcd8544_render_stop(handle);
+    pcd8544_async_reap(handle, portMAX_DELAY);
 
     // Reset LCD
-    pcd8544_reset();
+    pcd8544_reset(handle);
+
+    spi_bus_remove_device(handle->spi_handle);
 
-    spi_bus_remove_device(g_handle->spi_handle);
+    gpio_reset_pin(handle->io->rst_gpio_num);
+    gpio_reset_pin(handle->io->dc_gpio_num);
 
-    gpio_reset_pin(g_handle->io->rst_gpio_num);
-    gpio_reset_pin(g_handle->io->bkl_gpio_num);
-    gpio_reset_pin(g_handle->io->dc_gpio_num);
+    if (handle->backlight_pwm) {
+        gpio_reset_pin(handle->io->bkl_gpio_num);
+        s_ledc_channels &= ~(1 << handle->backlight_pwm->channel);
+    }
 
-    free(g_handle->backlight_pwm);
-    free(g_handle->io);
-    free(g_handle);
+    vSemaphoreDelete(handle->lock);
+    vSemaphoreDelete(handle->xfer_lock);
+    free(handle->backlight_pwm);
+    free(handle->io);
+    free(handle->shadow);
+    free(handle);
 
     ESP_LOGI(TAG, "Successfully deinitialized");
     return ESP_OK;
 }
 
-esp_err_t pcd8544_clear(void) {
-    if (!g_handle) return ESP_ERR_INVALID_STATE;
+esp_err_t pcd8544_clear(pcd8544_handle_t* handle) {
+    if (!handle) return ESP_ERR_INVALID_ARG;
+
+    PCD8544_LOCK(handle);
+    handle->_x = 0;
+    handle->_y = 0;
+    memset(handle->buffer, 0, PCD8544_BUFFER_SIZE);
+
+    pcd8544_update_area(handle, 0, 0, PCD8544_H_RES_MAX - 1,
+                        PCD8544_V_RES_MAX - 1);
+    PCD8544_UNLOCK(handle);
+
+    return ESP_OK;
+}
+
+// Send the planned runs of src, up to the first one that fails. The
+// controller RAM then differs from the shadow in unknown places.
+static esp_err_t pcd8544_flush_spans(pcd8544_handle_t* handle,
+                                     const uint8_t* src,
+                                     const pcd8544_span_t* spans, uint8_t n,
+                                     bool async) {
+    esp_err_t ret = ESP_OK;
+
+    for (uint8_t i = 0; i < n && ret == ESP_OK; i++)
+        ret = pcd8544_write_ram(
+            handle, spans[i].bank, spans[i].x,
+            &src[spans[i].bank * PCD8544_H_RES_MAX + spans[i].x], spans[i].len,
+            async);
+
+    if (ret != ESP_OK) {
+        handle->shadow_valid = false;
+        return ret;
+    }
+
+    handle->stats.flushes++;
+    return ESP_OK;
+}
+
+// Take both locks for planning a flush, and wait for the shadow to be out of
+// flight
+static void pcd8544_flush_begin(pcd8544_handle_t* handle) {
+    xSemaphoreTakeRecursive(handle->lock, portMAX_DELAY);
+    xSemaphoreTake(handle->xfer_lock, portMAX_DELAY);
+    pcd8544_async_reap(handle, portMAX_DELAY);
+}
+
+static esp_err_t pcd8544_flush_now(pcd8544_handle_t* handle) {
+    pcd8544_span_t spans[PCD8544_SPAN_MAX];
+    esp_err_t      ret = ESP_OK;
+
+    pcd8544_flush_begin(handle);
+    uint8_t n = pcd8544_plan_flush(handle, spans);
+    xSemaphoreGiveRecursive(handle->lock);
+
+    // Nothing has changed since the last flush
+    if (n) {
+        // Keep the bus for the whole frame instead of arbitrating every
+        // transfer
+        spi_device_acquire_bus(handle->spi_handle, portMAX_DELAY);
+        ret = pcd8544_flush_spans(handle, handle->shadow, spans, n, false);
+        spi_device_release_bus(handle->spi_handle);
+    }
+    xSemaphoreGive(handle->xfer_lock);
+
+    return ret;
+}
+
+esp_err_t pcd8544_flush(pcd8544_handle_t* handle) {
+    if (!handle) return ESP_ERR_INVALID_ARG;
+
+    // The render task sends the changes with its next frame, together with
+    // everything else drawn until then
+    if (handle->render_task) return ESP_OK;
+
+    return pcd8544_flush_now(handle);
+}
+
+esp_err_t pcd8544_flush_async(pcd8544_handle_t* handle,
+                              pcd8544_flush_done_cb_t cb, void* user_ctx) {
+    if (!handle) return ESP_ERR_INVALID_ARG;
+
+    // The render task owns the shadow and the async transactions
+    if (handle->render_task) return ESP_ERR_INVALID_STATE;
 
-    pcd8544_goto_xy(0, 0);
-    memset(g_handle->buffer, 0, PCD8544_BUFFER_SIZE);
+    // Planning snapshots the changes into the shadow, the buffer is free for
+    // drawing again afterwards
+    pcd8544_span_t spans[PCD8544_SPAN_MAX];
 
-    pcd8544_update_area(0, 0, PCD8544_H_RES_MAX - 1, PCD8544_V_RES_MAX - 1);
+    pcd8544_flush_begin(handle);
+    uint8_t n = pcd8544_plan_flush(handle, spans);
+    xSemaphoreGiveRecursive(handle->lock);
 
-    return pcd8544_flush();
+    if (!n) {
+        xSemaphoreGive(handle->xfer_lock);
+        if (cb) cb(user_ctx);
+        return ESP_OK;
+    }
+
+    // The callback fires on the last transaction, which has to be known before
+    // the first one can complete
+    handle->async_last   = &handle->async_trans[n * 2 - 1];
+    handle->async_cb     = cb;
+    handle->async_cb_ctx = user_ctx;
+
+    // What was queued before a failure is still sent, the last transaction
+    // and its callback never are
+    esp_err_t ret = pcd8544_flush_spans(handle, handle->shadow, spans, n, true);
+    if (ret != ESP_OK) handle->async_last = NULL;
+    xSemaphoreGive(handle->xfer_lock);
+
+    return ret;
 }
 
-esp_err_t pcd8544_flush(void) {
-    if (!g_handle) return ESP_ERR_INVALID_STATE;
+esp_err_t pcd8544_flush_wait(pcd8544_handle_t* handle,
+                             TickType_t        ticks_to_wait) {
+    if (!handle) return ESP_ERR_INVALID_ARG;
 
-    for (uint8_t i = 0; i < 6; i++) {
-        // Not in range yet
-        if (g_handle->update_ymin > ((i + 1) * 8)) continue;
+    if (xSemaphoreTake(handle->xfer_lock, ticks_to_wait) != pdTRUE)
+        return ESP_ERR_TIMEOUT;
+    esp_err_t ret = pcd8544_async_reap(handle, ticks_to_wait);
+    xSemaphoreGive(handle->xfer_lock);
 
-        // Over range, stop
-        if ((i * 8) > g_handle->update_ymax) break;
+    return ret;
+}
+
+esp_err_t pcd8544_flush_multi(pcd8544_handle_t* const handles[], size_t num) {
+    if (!handles) return ESP_ERR_INVALID_ARG;
 
-        pcd8544_send_cmd(PCD8544_SETYADDR | i);
-        pcd8544_send_cmd(PCD8544_SETXADDR | g_handle->update_xmin);
+    for (size_t i = 0; i < num; i++) {
+        if (!handles[i]) return ESP_ERR_INVALID_ARG;
+    }
 
-        for (uint8_t j = g_handle->update_xmin; j <= g_handle->update_xmax; j++)
-            pcd8544_send_data(g_handle->buffer[(i * PCD8544_H_RES_MAX) + j]);
+    // Nothing is queued unless every display can be
+    for (size_t i = 0; i < num; i++) {
+        if (handles[i]->render_task) return ESP_ERR_INVALID_STATE;
     }
 
-    g_handle->update_xmin = PCD8544_H_RES_MAX - 1;
-    g_handle->update_xmax = 0;
-    g_handle->update_ymin = PCD8544_V_RES_MAX - 1;
-    g_handle->update_ymax = 0;
+    // Queue every display first, the SPI driver then runs all transfers back
+    // to back without the caller in between. After an error the displays
+    // queued so far are still waited for.
+    esp_err_t ret    = ESP_OK;
+    size_t    queued = 0;
+
+    while (queued < num && ret == ESP_OK)
+        ret = pcd8544_flush_async(handles[queued++], NULL, NULL);
+
+    for (size_t i = 0; i < queued; i++) {
+        esp_err_t err = pcd8544_flush_wait(handles[i], portMAX_DELAY);
+        if (ret == ESP_OK) ret = err;
+    }
 
+    return ret;
+}
+
+static void pcd8544_render_task(void* arg) {
+    pcd8544_handle_t* handle = arg;
+    TickType_t        period =
+        MAX(pdMS_TO_TICKS(1000 / CONFIG_PCD8544_RENDER_FPS), (TickType_t)1);
+    TickType_t wake  = xTaskGetTickCount();
+    uint32_t   frame = 0;
+
+    while (!handle->render_stop) {
+        pcd8544_flush_now(handle);
+
+        EventBits_t vsync = frame++ % 2 ? PCD8544_RENDER_VSYNC_ODD
+                                        : PCD8544_RENDER_VSYNC_EVEN;
+        xEventGroupClearBits(handle->render_events,
+                             vsync ^ (PCD8544_RENDER_VSYNC_EVEN |
+                                      PCD8544_RENDER_VSYNC_ODD));
+        xEventGroupSetBits(handle->render_events, vsync);
+
+        vTaskDelayUntil(&wake, period);
+    }
+
+    xEventGroupSetBits(handle->render_events, PCD8544_RENDER_STOPPED);
+    vTaskDelete(NULL);
+}
+
+esp_err_t pcd8544_render_start(pcd8544_handle_t* handle) {
+    if (!handle) return ESP_ERR_INVALID_ARG;
+    if (handle->render_task) return ESP_ERR_INVALID_STATE;
+
+    handle->render_events = xEventGroupCreate();
+    if (!handle->render_events) return ESP_ERR_NO_MEM;
+    handle->render_stop = false;
+
+    if (xTaskCreate(pcd8544_render_task, "pcd8544_render",
+                    PCD8544_RENDER_TASK_STACK, handle,
+                    PCD8544_RENDER_TASK_PRIO,
+                    &handle->render_task) != pdPASS) {
+        vEventGroupDelete(handle->render_events);
+        handle->render_events = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t pcd8544_render_stop(pcd8544_handle_t* handle) {
+    if (!handle) return ESP_ERR_INVALID_ARG;
+    if (!handle->render_task) return ESP_ERR_INVALID_STATE;
+
+    handle->render_stop = true;
+    xEventGroupWaitBits(handle->render_events, PCD8544_RENDER_STOPPED, pdFALSE,
+                        pdTRUE, portMAX_DELAY);
+
+    vEventGroupDelete(handle->render_events);
+    handle->render_events = NULL;
+    handle->render_task   = NULL;
+
+    // Send what was drawn after the last frame
+    return pcd8544_flush_now(handle);
+}
+
+esp_err_t pcd8544_wait_vsync(pcd8544_handle_t* handle,
+                             TickType_t        ticks_to_wait) {
+    if (!handle) return ESP_ERR_INVALID_ARG;
+    if (!handle->render_task) return ESP_ERR_INVALID_STATE;
+
+    // Wait for the bit the current frame has not set
+    EventBits_t bits = xEventGroupGetBits(handle->render_events);
+    EventBits_t next = bits & PCD8544_RENDER_VSYNC_EVEN
+                           ? PCD8544_RENDER_VSYNC_ODD
+                           : PCD8544_RENDER_VSYNC_EVEN;
+
+    bits = xEventGroupWaitBits(handle->render_events, next, pdFALSE, pdTRUE,
+                               ticks_to_wait);
+    return bits & next ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+esp_err_t pcd8544_get_stats(pcd8544_handle_t* handle, pcd8544_stats_t* stats) {
+    if (!handle || !stats) return ESP_ERR_INVALID_ARG;
+    *stats = handle->stats;
     return ESP_OK;
 }
 
-esp_err_t pcd8544_invert(bool invert) {
-    if (!g_handle) return ESP_ERR_INVALID_STATE;
-    pcd8544_send_cmd(PCD8544_DISPLAYCONTROL | (invert ? PCD8544_DISPLAYINVERTED
+esp_err_t pcd8544_reset_stats(pcd8544_handle_t* handle) {
+    if (!handle) return ESP_ERR_INVALID_ARG;
+    memset(&handle->stats, 0, sizeof(pcd8544_stats_t));
+    return ESP_OK;
+}
+
+esp_err_t pcd8544_invert(pcd8544_handle_t* handle, bool invert) {
+    if (!handle) return ESP_ERR_INVALID_ARG;
+
+    xSemaphoreTake(handle->xfer_lock, portMAX_DELAY);
+    pcd8544_send_cmd(handle,
+                     PCD8544_DISPLAYCONTROL | (invert ? PCD8544_DISPLAYINVERTED
                                                       : PCD8544_DISPLAYNORMAL));
+    xSemaphoreGive(handle->xfer_lock);
     return ESP_OK;
 }
 
-esp_err_t pcd8544_is_inverted(bool* inverted) {
-    if (!g_handle) return ESP_ERR_INVALID_STATE;
-    *inverted = g_handle->is_inverted;
+esp_err_t pcd8544_is_inverted(pcd8544_handle_t* handle, bool* inverted) {
+    if (!handle) return ESP_ERR_INVALID_ARG;
+    *inverted = handle->is_inverted;
     return ESP_OK;
 }
 
-esp_err_t pcd8544_set_contrast(uint8_t contrast) {
-    if (!g_handle) return ESP_ERR_INVALID_STATE;
+esp_err_t pcd8544_set_contrast(pcd8544_handle_t* handle, uint8_t contrast) {
+    if (!handle) return ESP_ERR_INVALID_ARG;
+
+    xSemaphoreTake(handle->xfer_lock, portMAX_DELAY);
 
     // Go in extended mode
-    pcd8544_send_cmd(PCD8544_FUNCTIONSET | PCD8544_EXTENDEDINSTRUCTION);
+    pcd8544_send_cmd(handle, PCD8544_FUNCTIONSET | PCD8544_EXTENDEDINSTRUCTION);
 
     // Set VOP
     contrast = MIN(0, 0x7F);
-    pcd8544_send_cmd(PCD8544_SETVOP | contrast);
+    pcd8544_send_cmd(handle, PCD8544_SETVOP | contrast);
 
     // Normal mode
-    pcd8544_send_cmd(PCD8544_FUNCTIONSET);
+    pcd8544_send_cmd(handle, PCD8544_FUNCTIONSET);
 
+    xSemaphoreGive(handle->xfer_lock);
     return ESP_OK;
 }
 
-esp_err_t pcd8544_set_backlight(uint8_t brightness) {
-    if (!g_handle) return ESP_ERR_INVALID_STATE;
+esp_err_t pcd8544_set_backlight(pcd8544_handle_t* handle, uint8_t brightness) {
+    if (!handle) return ESP_ERR_INVALID_ARG;
+    if (!handle->backlight_pwm) return ESP_ERR_INVALID_STATE;
 
-    ledc_set_duty(g_handle->backlight_pwm->speed_mode,
-                  g_handle->backlight_pwm->channel,
+    ledc_set_duty(handle->backlight_pwm->speed_mode,
+                  handle->backlight_pwm->channel,
                   (MIN(brightness, 100) * 8192) / 100);
 
-    ledc_update_duty(g_handle->backlight_pwm->speed_mode,
-                     g_handle->backlight_pwm->channel);
+    ledc_update_duty(handle->backlight_pwm->speed_mode,
+                     handle->backlight_pwm->channel);
 
     return ESP_OK;
 }
 
-esp_err_t pcd8544_set_backlight_fade(uint8_t brightness, int max_fade_time_ms,
+esp_err_t pcd8544_set_backlight_fade(pcd8544_handle_t* handle,
+                                     uint8_t brightness, int max_fade_time_ms,
                                      bool wait_fade_done) {
-    if (!g_handle) return ESP_ERR_INVALID_STATE;
+    if (!handle) return ESP_ERR_INVALID_ARG;
+    if (!handle->backlight_pwm) return ESP_ERR_INVALID_STATE;
 
     ledc_set_fade_with_time(
-        g_handle->backlight_pwm->speed_mode, g_handle->backlight_pwm->channel,
+        handle->backlight_pwm->speed_mode, handle->backlight_pwm->channel,
         (MIN(brightness, 100) * 8192) / 100, max_fade_time_ms);
 
-    ledc_fade_start(g_handle->backlight_pwm->speed_mode,
-                    g_handle->backlight_pwm->channel,
+    ledc_fade_start(handle->backlight_pwm->speed_mode,
+                    handle->backlight_pwm->channel,
                     wait_fade_done ? LEDC_FADE_WAIT_DONE : LEDC_FADE_NO_WAIT);
 
     return ESP_OK;
 }
 
-esp_err_t pcd8544_goto_xy(uint8_t x, uint8_t y) {
-    if (!g_handle) return ESP_ERR_INVALID_STATE;
-    g_handle->_x = x;
-    g_handle->_y = y;
+esp_err_t pcd8544_begin(pcd8544_handle_t* handle) {
+    if (!handle) return ESP_ERR_INVALID_ARG;
+    xSemaphoreTakeRecursive(handle->lock, portMAX_DELAY);
     return ESP_OK;
 }
 
-esp_err_t pcd8544_putc(pcd8544_font_t font, pcd8544_pixel_color_t color,
-                       char c) {
-    if (!g_handle) return ESP_ERR_INVALID_STATE;
+esp_err_t pcd8544_end(pcd8544_handle_t* handle) {
+    if (!handle) return ESP_ERR_INVALID_ARG;
+    if (xSemaphoreGiveRecursive(handle->lock) != pdTRUE)
+        return ESP_ERR_INVALID_STATE;
+    return ESP_OK;
+}
 
-    uint8_t c_height, c_width, b;
+esp_err_t pcd8544_goto_xy(pcd8544_handle_t* handle, uint8_t x, uint8_t y) {
+    if (!handle) return ESP_ERR_INVALID_ARG;
 
-    if (font == PCD8544_FONT_3x5) {
-        c_width  = PCD8544_CHAR3x5_WIDTH;
-        c_height = PCD8544_CHAR3x5_HEIGHT;
+    PCD8544_LOCK(handle);
+    handle->_x = x;
+    handle->_y = y;
+    PCD8544_UNLOCK(handle);
+    return ESP_OK;
+}
+
+esp_err_t pcd8544_set_terminal_mode(pcd8544_handle_t* handle, bool enable) {
+    if (!handle) return ESP_ERR_INVALID_ARG;
+
+    PCD8544_LOCK(handle);
+    handle->terminal_mode = enable;
+    PCD8544_UNLOCK(handle);
+    return ESP_OK;
+}
+
+#define PCD8544_RANGE_NUM(ranges) (sizeof(ranges) / sizeof((ranges)[0]))
+
+const pcd8544_font_desc_t pcd8544_font_3x5 = {
+    .bitmap = pcd8544_3x5_charset[0],
+    .first  = ' ',
+    .last   = '~',
+    .width  = PCD8544_CHAR3x5_WIDTH - 1,
+    .height = PCD8544_CHAR3x5_HEIGHT,
+    .stride = 8,
+};
+
+const pcd8544_font_desc_t pcd8544_font_5x7 = {
+    .bitmap = pcd8544_5x7_charset[0],
+    .first  = ' ',
+    .last   = '~',
+    .width  = PCD8544_CHAR5x7_WIDTH - 1,
+    .height = PCD8544_CHAR5x7_HEIGHT,
+    .stride = 8,
+};
+
+const pcd8544_font_desc_t pcd8544_font_5x7_prop = {
+    .bitmap    = pcd8544_5x7_prop_bitmap,
+    .glyphs    = pcd8544_5x7_prop_glyphs,
+    .ranges    = pcd8544_5x7_prop_ranges,
+    .range_num = PCD8544_RANGE_NUM(pcd8544_5x7_prop_ranges),
+    .height    = 8,
+    .stride    = 8,
+};
+
+const pcd8544_font_desc_t pcd8544_font_8x16_digits = {
+    .bitmap    = pcd8544_8x16_digits_bitmap,
+    .glyphs    = pcd8544_8x16_digits_glyphs,
+    .ranges    = pcd8544_8x16_digits_ranges,
+    .range_num = PCD8544_RANGE_NUM(pcd8544_8x16_digits_ranges),
+    .height    = 16,
+    .stride    = 16,
+};
+
+const pcd8544_font_desc_t pcd8544_font_12x24_digits = {
+    .bitmap    = pcd8544_12x24_digits_bitmap,
+    .glyphs    = pcd8544_12x24_digits_glyphs,
+    .ranges    = pcd8544_12x24_digits_ranges,
+    .range_num = PCD8544_RANGE_NUM(pcd8544_12x24_digits_ranges),
+    .height    = 24,
+    .stride    = 24,
+};
+
+// Descriptors of the pcd8544_font_t fonts
+static const pcd8544_font_desc_t* const pcd8544_fonts[] = {
+    [PCD8544_FONT_3x5] = &pcd8544_font_3x5,
+    [PCD8544_FONT_5x7] = &pcd8544_font_5x7,
+};
+
+bool pcd8544_font_exists(pcd8544_font_t font) {
+    return (unsigned)font < sizeof(pcd8544_fonts) / sizeof(pcd8544_fonts[0]);
+}
 
+void pcd8544_font_cell(pcd8544_font_t font, uint8_t* width, uint8_t* height) {
+    *width  = pcd8544_fonts[font]->width + 1;
+    *height = pcd8544_fonts[font]->height;
+}
+
+const pcd8544_font_desc_t* pcd8544_font_desc(pcd8544_font_t font) {
+    return pcd8544_fonts[font];
+}
+
+// Write a 5x7 character cell straight to the controller RAM, updating the
+// buffer and the shadow with it. The glyph is applied to the cell in the
+// buffer with the same raster op as pcd8544_draw_glyph() uses, and the cell
+// is sent as a whole. Right after another character the address counter is
+// already in place and only the 6 data bytes are sent.
+static void pcd8544_draw_char_direct(pcd8544_handle_t*     handle,
+                                     pcd8544_pixel_color_t color,
+                                     const uint8_t*        glyph) {
+    uint8_t  bank   = handle->_y / 8;
+    uint16_t offset = bank * PCD8544_H_RES_MAX + handle->_x;
+    uint8_t* cell   = &handle->shadow[offset];
+
+    // The shadow is sent from, it must not be in flight while it changes
+    xSemaphoreTake(handle->xfer_lock, portMAX_DELAY);
+    pcd8544_async_reap(handle, portMAX_DELAY);
+
+    // The glyph is 8 rows tall, a copy covers the whole of every column
+    for (uint8_t i = 0; i < PCD8544_CHAR5x7_WIDTH; i++) {
+        uint8_t bits = i < PCD8544_CHAR5x7_WIDTH - 1 ? glyph[i] : 0;
+
+        cell[i] = handle->buffer[offset + i];
+        pcd8544_rop(&cell[i], bits, 0xFF, color);
+    }
+    memcpy(&handle->buffer[offset], cell, PCD8544_CHAR5x7_WIDTH);
+    // Written without pcd8544_update_area(), which forgets the template
+    handle->shown_template = NULL;
+
+    esp_err_t ret;
+
+    if (handle->ram_next == offset) {
+        ret = pcd8544_send_data(handle, cell, PCD8544_CHAR5x7_WIDTH);
+        handle->ram_next =
+            ret == ESP_OK
+                ? (offset + PCD8544_CHAR5x7_WIDTH) % PCD8544_BUFFER_SIZE
+                : UINT16_MAX;
     } else {
-        c_width  = PCD8544_CHAR5x7_WIDTH;
-        c_height = PCD8544_CHAR5x7_HEIGHT;
+        ret = pcd8544_write_ram(handle, bank, handle->_x, cell,
+                                PCD8544_CHAR5x7_WIDTH, false);
     }
 
-    if ((g_handle->_x + c_width) > PCD8544_H_RES_MAX) {
+    // The cell is in the buffer, the next flush sends it with the rest
+    if (ret != ESP_OK) handle->shadow_valid = false;
+    xSemaphoreGive(handle->xfer_lock);
+}
+
+// Read a glyph column of bits rows starting at bit offset of the bitmap,
+// top row in bit 0. Only the bytes holding the column are read.
+static uint32_t pcd8544_font_column(const uint8_t* bitmap, uint32_t offset,
+                                    uint8_t bits) {
+    const uint8_t* p      = &bitmap[offset / 8];
+    uint8_t        shift  = offset % 8;
+    uint64_t       column = 0;
+
+    // Column bytes of fonts in the display layout
+    if (!shift && bits <= 8) return p[0] & ((1 << bits) - 1);
+
+    for (uint8_t i = 0; i * 8 < shift + bits; i++)
+        column |= (uint64_t)p[i] << (i * 8);
+
+    return (column >> shift) & ((1ULL << bits) - 1);
+}
+
+// Find the glyph of a code point, false when the font has none. Sparse fonts
+// keep sorted ranges of code points, found by binary search.
+bool pcd8544_font_glyph(const pcd8544_font_desc_t* font, uint32_t code,
+                        pcd8544_glyph_t* glyph) {
+    uint32_t index;
+
+    if (font->ranges) {
+        uint16_t lo = 0;
+        uint16_t hi = font->range_num;
+
+        for (;;) {
+            if (lo == hi) return false;
+
+            uint16_t                     mid   = (lo + hi) / 2;
+            const pcd8544_glyph_range_t* range = &font->ranges[mid];
+
+            if (code < range->first) {
+                hi = mid;
+            } else if (code > range->last) {
+                lo = mid + 1;
+            } else {
+                index = range->glyph + (code - range->first);
+                break;
+            }
+        }
+    } else {
+        if (code < font->first || code > font->last) return false;
+        index = code - font->first;
+    }
+
+    if (font->glyphs) {
+        *glyph = font->glyphs[index];
+    } else {
+        glyph->offset  = index * font->width * font->stride;
+        glyph->width   = font->width;
+        glyph->advance = font->width + 1;
+    }
+    return true;
+}
+
+void pcd8544_draw_glyph(pcd8544_handle_t*          handle,
+                        const pcd8544_font_desc_t* font,
+                        pcd8544_pixel_color_t color, uint32_t code) {
+    pcd8544_glyph_t glyph;
+
+    if (!pcd8544_font_glyph(font, code, &glyph)) return;
+
+    uint32_t offset  = glyph.offset;
+    uint8_t  width   = glyph.width;
+    uint8_t  advance = glyph.advance;
+
+    if ((handle->_x + advance) > PCD8544_H_RES_MAX) {
         // If at the end of a line of display, go to new line and set x to 0
-        // position
-        g_handle->_y += c_height;
-        g_handle->_x = 0;
+        // position. Text past the bottom is dropped, the cursor stays below
+        // the display instead of wrapping around to its top.
+        handle->_y = MIN(handle->_y + font->height, PCD8544_V_RES_MAX);
+        handle->_x = 0;
     }
 
-    for (uint8_t i = 0; i < c_width - 1; i++) {
-        if (font == PCD8544_FONT_3x5) {
-            b = pcd8544_3x5_charset[c - 32][i];
-        } else {
-            b = pcd8544_5x7_charset[c - 32][i];
+    // The render task sends from the shadow on its own, and the shadow only
+    // matches the controller after the first flush
+    if (handle->terminal_mode && font == &pcd8544_font_5x7 &&
+        handle->_y % 8 == 0 && handle->_y < PCD8544_V_RES_MAX &&
+        handle->shadow_valid && !handle->render_task) {
+        xSemaphoreTakeRecursive(handle->lock, portMAX_DELAY);
+        pcd8544_draw_char_direct(handle, color, &font->bitmap[offset / 8]);
+        xSemaphoreGiveRecursive(handle->lock);
+
+        handle->_x += advance;
+        return;
+    }
+
+    // A copy draws the whole cell, the spacing after the glyph included
+    bool    copy = color == PCD8544_PIXEL_COPY;
+    uint8_t cols = copy ? advance : width;
+
+    // Columns taller than a bank go down a byte at a time, every byte through
+    // the same blit as 8 row glyphs
+    for (uint8_t i = 0; i < cols; i++, offset += font->stride) {
+        uint32_t column =
+            i < width ? pcd8544_font_column(font->bitmap, offset, font->height)
+                      : 0;
+
+        for (uint8_t row = 0; row < font->height; row += 8) {
+            if (handle->_y + row >= PCD8544_V_RES_MAX) break;
+            if (column >> row & 0xFF || copy)
+                pcd8544_blit_byte(handle, handle->_x + i, handle->_y + row,
+                                  column >> row,
+                                  pcd8544_area_rows(font->height - row),
+                                  color);
         }
+    }
 
-        // if (b == 0x00 && (c != 0 && c != 32)) continue;
+    if (cols && handle->_y < PCD8544_V_RES_MAX)
+        pcd8544_update_area(
+            handle, handle->_x, handle->_y,
+            MIN(handle->_x + cols - 1, PCD8544_H_RES_MAX - 1),
+            MIN(handle->_y + font->height - 1, PCD8544_V_RES_MAX - 1));
 
-        for (uint8_t j = 0; j < c_height; j++) {
-            if ((b >> j) & 1)
-                pcd8544_draw_pixel(g_handle->_x, (g_handle->_y + j), color);
-        }
+    handle->_x += advance;
+}
+
+void pcd8544_draw_char(pcd8544_handle_t* handle, pcd8544_font_t font,
+                       pcd8544_pixel_color_t color, char c) {
+    pcd8544_draw_glyph(handle, pcd8544_fonts[font], color, (uint8_t)c);
+}
+
+esp_err_t pcd8544_putc(pcd8544_handle_t* handle, pcd8544_font_t font,
+                       pcd8544_pixel_color_t color, char c) {
+    if (!handle || !pcd8544_font_exists(font)) return ESP_ERR_INVALID_ARG;
 
-        g_handle->_x++;
+    PCD8544_LOCK(handle);
+    pcd8544_draw_char(handle, font, color, c);
+    PCD8544_UNLOCK(handle);
+    return ESP_OK;
+}
+
+uint32_t pcd8544_utf8_next(const char** str, const char* end) {
+    const uint8_t* s    = (const uint8_t*)*str;
+    uint32_t       code = s[0];
+    uint32_t       min;
+    uint8_t        len;
+
+    if (code < 0x80) {
+        *str += 1;
+        return code;
+    }
+
+    if ((code & 0xE0) == 0xC0) {
+        len  = 2;
+        min  = 0x80;
+        code &= 0x1F;
+    } else if ((code & 0xF0) == 0xE0) {
+        len  = 3;
+        min  = 0x800;
+        code &= 0x0F;
+    } else if ((code & 0xF8) == 0xF0) {
+        len  = 4;
+        min  = 0x10000;
+        code &= 0x07;
+    } else {
+        *str += 1;
+        return PCD8544_UTF8_INVALID;
     }
 
-    g_handle->_x++;
+    for (uint8_t i = 1; i < len; i++) {
+        if (&s[i] >= (const uint8_t*)end || (s[i] & 0xC0) != 0x80) {
+            *str += i;
+            return PCD8544_UTF8_INVALID;
+        }
+        code = code << 6 | (s[i] & 0x3F);
+    }
+    *str += len;
+
+    // Overlong forms and surrogates
+    if (code < min || code > 0x10FFFF || (code >= 0xD800 && code <= 0xDFFF))
+        return PCD8544_UTF8_INVALID;
+    return code;
+}
+
+void pcd8544_draw_utf8(pcd8544_handle_t*          handle,
+                       const pcd8544_font_desc_t* font,
+                       pcd8544_pixel_color_t color, const char* str,
+                       size_t len) {
+    const char* end = str + len;
+
+    while (str < end)
+        pcd8544_draw_glyph(handle, font, color, pcd8544_utf8_next(&str, end));
+}
+
+typedef struct {
+    pcd8544_handle_t*          handle;
+    const pcd8544_font_desc_t* font;
+    pcd8544_pixel_color_t      color;
+} pcd8544_puts_ctx_t;
+
+// Draw the text of the formatter as it comes, a character never spans two
+// pieces of it
+static void pcd8544_puts_emit(void* ctx, const char* str, size_t len) {
+    pcd8544_puts_ctx_t* puts = ctx;
+
+    pcd8544_draw_utf8(puts->handle, puts->font, puts->color, str, len);
+}
+
+// Format a string and draw it with a font descriptor, under one lock
+static void pcd8544_vputs(pcd8544_handle_t*          handle,
+                          const pcd8544_font_desc_t* font,
+                          pcd8544_pixel_color_t color, const char* format,
+                          va_list arg) {
+    pcd8544_puts_ctx_t ctx = {handle, font, color};
+
+    PCD8544_LOCK(handle);
+    pcd8544_format(pcd8544_puts_emit, &ctx, format, arg);
+    PCD8544_UNLOCK(handle);
+}
+
+esp_err_t pcd8544_puts(pcd8544_handle_t* handle, pcd8544_font_t font,
+                       pcd8544_pixel_color_t color, const char* format, ...) {
+    if (!handle || !pcd8544_font_exists(font) || !format)
+        return ESP_ERR_INVALID_ARG;
+
+    va_list arg;
+
+    va_start(arg, format);
+    pcd8544_vputs(handle, pcd8544_fonts[font], color, format, arg);
+    va_end(arg);
 
     return ESP_OK;
 }
 
-esp_err_t pcd8544_puts(pcd8544_font_t font, pcd8544_pixel_color_t color,
-                       const char* format, ...) {
-    esp_err_t ret = ESP_OK;
-    char      temp_str[84];
-    va_list   arg;
+bool pcd8544_font_valid(const pcd8544_font_desc_t* font) {
+    return font && font->height && font->height <= PCD8544_FONT_HEIGHT_MAX &&
+           font->stride >= font->height;
+}
+
+esp_err_t pcd8544_putc_font(pcd8544_handle_t*          handle,
+                            const pcd8544_font_desc_t* font,
+                            pcd8544_pixel_color_t color, uint32_t code) {
+    if (!handle || !pcd8544_font_valid(font)) return ESP_ERR_INVALID_ARG;
+
+    PCD8544_LOCK(handle);
+    pcd8544_draw_glyph(handle, font, color, code);
+    PCD8544_UNLOCK(handle);
+    return ESP_OK;
+}
+
+esp_err_t pcd8544_puts_font(pcd8544_handle_t*          handle,
+                            const pcd8544_font_desc_t* font,
+                            pcd8544_pixel_color_t color, const char* format,
+                            ...) {
+    if (!handle || !pcd8544_font_valid(font) || !format)
+        return ESP_ERR_INVALID_ARG;
+
+    va_list arg;
 
     va_start(arg, format);
-    vsnprintf(temp_str, 84, format, arg);
+    pcd8544_vputs(handle, font, color, format, arg);
+    va_end(arg);
+
+    return ESP_OK;
+}
+
+// Lay out the line of text starting at *str: returns its width in pixels,
+// sets *line_end to the end of its text and moves *str to the next line.
+// With a max_width, the line breaks at the last space that fits, or inside a
+// word wider than max_width. Spaces at a break belong to neither line.
+static uint16_t pcd8544_text_line(const pcd8544_font_desc_t* font,
+                                  const char** str, const char* end,
+                                  uint8_t max_width, const char** line_end) {
+    const char*     s         = *str;
+    const char*     space     = NULL;  // Last space the line can break at
+    uint16_t        pen       = 0;
+    uint16_t        width     = 0;
+    uint16_t        space_pen = 0;
+    pcd8544_glyph_t glyph;
+
+    while (s < end) {
+        const char* c    = s;
+        uint32_t    code = pcd8544_utf8_next(&s, end);
+
+        if (code == '\n') {
+            *line_end = c;
+            *str      = s;
+            return width;
+        }
+        if (!pcd8544_font_glyph(font, code, &glyph)) continue;
 
-    for (uint8_t i = 0; i < strlen(temp_str); i++) {
-        ret = pcd8544_putc(font, color, temp_str[i]);
-        if (ret != ESP_OK) break;
+        if (code == ' ') {
+            if (!space || space_pen != width) space = c;
+            space_pen = width;
+            pen += glyph.advance;
+            continue;
+        }
+
+        // The first character always fits, so every line takes some text
+        if (max_width && c != *str && pen + glyph.width > max_width) {
+            if (space) {
+                for (s = space; s < end && *s == ' '; s++) {
+                }
+                *line_end = space;
+                *str      = s;
+                return space_pen;
+            }
+            *line_end = c;
+            *str      = c;
+            return width;
+        }
+
+        width = pen + glyph.width;
+        pen += glyph.advance;
     }
 
-    va_end(arg);
-    return ret;
+    *line_end = end;
+    *str      = end;
+    return width;
 }
 
-esp_err_t pcd8544_draw_pixel(uint8_t x, uint8_t y,
-                             pcd8544_pixel_color_t color) {
-    if (!g_handle) return ESP_ERR_INVALID_STATE;
+// Draw a glyph with its top left corner at x, y, only the pixels of it that
+// are inside x0, y0 ~ x1, y1. The caller updates the dirty area.
+static void pcd8544_draw_glyph_clipped(pcd8544_handle_t*          handle,
+                                       const pcd8544_font_desc_t* font,
+                                       const pcd8544_glyph_t*     glyph,
+                                       int16_t x, int16_t y, uint8_t x0,
+                                       uint8_t y0, uint8_t x1, uint8_t y1,
+                                       pcd8544_pixel_color_t color) {
+    int16_t top    = MAX(y, y0);
+    int16_t bottom = MIN(y + font->height - 1, y1);
+
+    if (top > bottom) return;
+
+    uint8_t  skip   = top - y;
+    uint8_t  rows   = bottom - top + 1;
+    uint32_t mask   = rows < 32 ? (1UL << rows) - 1 : UINT32_MAX;
+    uint32_t offset = glyph->offset;
+
+    for (uint8_t i = 0; i < glyph->width; i++, offset += font->stride) {
+        if (x + i < x0) continue;
+        if (x + i > x1) break;
+
+        uint32_t column =
+            pcd8544_font_column(font->bitmap, offset, font->height) >> skip &
+            mask;
+
+        for (uint8_t row = 0; row < rows; row += 8)
+            if (column >> row & 0xFF)
+                pcd8544_blit_byte(handle, x + i, top + row, column >> row,
+                                  0xFF, color);
+    }
+}
 
-    if (x >= PCD8544_H_RES_MAX || y >= PCD8544_V_RES_MAX)
+esp_err_t pcd8544_text_extent(const pcd8544_font_desc_t* font, const char* str,
+                              uint8_t max_width, uint16_t* width,
+                              uint16_t* height) {
+    if (!pcd8544_font_valid(font) || !str || !width || !height)
         return ESP_ERR_INVALID_ARG;
 
-    if (color == PCD8544_PIXEL_BLACK)
-        g_handle->buffer[x + (y / 8) * PCD8544_H_RES_MAX] |= 1 << (y % 8);
-    else
-        g_handle->buffer[x + (y / 8) * PCD8544_H_RES_MAX] &= ~(1 << (y % 8));
+    const char* end   = str + strlen(str);
+    uint16_t    lines = 0;
+    const char* line_end;
+
+    *width = 0;
+    while (str < end) {
+        uint16_t line = pcd8544_text_line(font, &str, end, max_width,
+                                          &line_end);
+
+        *width = MAX(*width, line);
+        lines++;
+    }
+    *height = lines * font->height;
 
-    pcd8544_update_area(x, y, x, y);
     return ESP_OK;
 }
 
-esp_err_t pcd8544_draw_line(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1,
-                            pcd8544_pixel_color_t color) {
-    if (!g_handle) return ESP_ERR_INVALID_STATE;
+esp_err_t pcd8544_draw_text_box(pcd8544_handle_t*          handle,
+                                const pcd8544_font_desc_t* font,
+                                pcd8544_pixel_color_t color, uint8_t x0,
+                                uint8_t y0, uint8_t x1, uint8_t y1,
+                                uint8_t flags, const char* str) {
+    if (!handle || !pcd8544_font_valid(font) || !str)
+        return ESP_ERR_INVALID_ARG;
+
+    if (!pcd8544_clip_area(&x0, &y0, &x1, &y1)) return ESP_OK;
+
+    const char* end       = str + strlen(str);
+    uint8_t     box_w     = x1 - x0 + 1;
+    uint8_t     box_h     = y1 - y0 + 1;
+    uint8_t     max_width = (flags & PCD8544_TEXT_WRAP) ? box_w : 0;
+    int16_t     y         = y0;
+    const char* line_end;
+
+    // Text taller than the box is cut off at the side it is aligned away
+    // from, the middle keeps the centre lines
+    if (flags & (PCD8544_ALIGN_MIDDLE | PCD8544_ALIGN_BOTTOM)) {
+        uint16_t width, height;
+
+        pcd8544_text_extent(font, str, max_width, &width, &height);
+        y += (flags & PCD8544_ALIGN_BOTTOM) ? box_h - height
+                                            : (box_h - height) / 2;
+    }
+
+    // The box is the background of a copy, already cleared
+    if (color == PCD8544_PIXEL_COPY) color = PCD8544_PIXEL_BLACK;
+
+    PCD8544_LOCK(handle);
+    pcd8544_fill_span(handle, x0, y0, x1, y1,
+                      color == PCD8544_PIXEL_WHITE ? PCD8544_PIXEL_BLACK
+                                                   : PCD8544_PIXEL_WHITE);
+
+    while (str < end && y <= y1) {
+        const char* line  = str;
+        uint16_t    width = pcd8544_text_line(font, &str, end, max_width,
+                                              &line_end);
+        int16_t     x     = x0;
+
+        if (flags & PCD8544_ALIGN_RIGHT)
+            x += box_w - width;
+        else if (flags & PCD8544_ALIGN_CENTER)
+            x += (box_w - width) / 2;
+
+        // Lines above the box are only laid out
+        while (y + font->height > y0 && line < line_end && x <= x1) {
+            pcd8544_glyph_t glyph;
+
+            if (pcd8544_font_glyph(font, pcd8544_utf8_next(&line, line_end),
+                                   &glyph)) {
+                pcd8544_draw_glyph_clipped(handle, font, &glyph, x, y, x0, y0,
+                                           x1, y1, color);
+                x += glyph.advance;
+            }
+        }
+        y += font->height;
+    }
+
+    pcd8544_update_area(handle, x0, y0, x1, y1);
+    PCD8544_UNLOCK(handle);
+
+    return ESP_OK;
+}
+
+void pcd8544_plot(pcd8544_handle_t* handle, uint8_t x, uint8_t y,
+                  pcd8544_pixel_color_t color) {
+    if (x >= PCD8544_H_RES_MAX || y >= PCD8544_V_RES_MAX) return;
+
+    pcd8544_rop(&handle->buffer[x + (y / 8) * PCD8544_H_RES_MAX],
+                1 << (y % 8), 1 << (y % 8), color);
+
+    pcd8544_update_area(handle, x, y, x, y);
+}
 
+esp_err_t pcd8544_draw_pixel(pcd8544_handle_t* handle, uint8_t x, uint8_t y,
+                             pcd8544_pixel_color_t color) {
+    if (!handle) return ESP_ERR_INVALID_ARG;
+
+    if (x >= PCD8544_H_RES_MAX || y >= PCD8544_V_RES_MAX)
+        return ESP_ERR_INVALID_ARG;
+
+    PCD8544_LOCK(handle);
+    pcd8544_plot(handle, x, y, color);
+    PCD8544_UNLOCK(handle);
+    return ESP_OK;
+}
+
+void pcd8544_line(pcd8544_handle_t* handle, uint8_t x0, uint8_t y0, uint8_t x1,
+                  uint8_t y1, pcd8544_pixel_color_t color) {
     uint8_t dx, dy, temp;
 
     if (x0 > x1) {
@@ -390,27 +1449,17 @@ esp_err_t pcd8544_draw_line(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1,
     dx = x1 - x0;
     dy = y1 - y0;
 
-    if (dx == 0) {
-        do {
-            pcd8544_draw_pixel(x0, y0, color);
-            y0++;
-        } while (y1 >= y0);
-        return ESP_OK;
-    }
-
-    if (dy == 0) {
-        do {
-            pcd8544_draw_pixel(x0, y0, color);
-            x0++;
-        } while (x1 >= x0);
-        return ESP_OK;
+    // Vertical and horizontal lines are spans of whole bytes
+    if (dx == 0 || dy == 0) {
+        pcd8544_fill_area(handle, x0, y0, x1, y1, color);
+        return;
     }
 
     /* Based on Bresenham's line algorithm  */
     if (dx > dy) {
         temp = 2 * dy - dx;
         while (x0 != x1) {
-            pcd8544_draw_pixel(x0, y0, color);
+            pcd8544_plot(handle, x0, y0, color);
             x0++;
             if (temp > 0) {
                 y0++;
@@ -419,12 +1468,12 @@ esp_err_t pcd8544_draw_line(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1,
                 temp += 2 * dy;
             }
         }
-        pcd8544_draw_pixel(x0, y0, color);
+        pcd8544_plot(handle, x0, y0, color);
 
     } else {
         temp = 2 * dx - dy;
         while (y0 != y1) {
-            pcd8544_draw_pixel(x0, y0, color);
+            pcd8544_plot(handle, x0, y0, color);
             y0++;
             if (temp > 0) {
                 x0++;
@@ -433,46 +1482,96 @@ esp_err_t pcd8544_draw_line(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1,
                 temp += 2 * dy;
             }
         }
-        pcd8544_draw_pixel(x0, y0, color);
+        pcd8544_plot(handle, x0, y0, color);
     }
-    return ESP_OK;
 }
 
-esp_err_t pcd8544_draw_rectagle(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1,
-                                pcd8544_pixel_color_t color, bool filled) {
-    if (!g_handle) return ESP_ERR_INVALID_STATE;
+esp_err_t pcd8544_draw_line(pcd8544_handle_t* handle, uint8_t x0, uint8_t y0,
+                            uint8_t x1, uint8_t y1,
+                            pcd8544_pixel_color_t color) {
+    if (!handle) return ESP_ERR_INVALID_ARG;
+
+    PCD8544_LOCK(handle);
+    pcd8544_line(handle, x0, y0, x1, y1, color);
+    PCD8544_UNLOCK(handle);
+    return ESP_OK;
+}
 
+void pcd8544_rectangle(pcd8544_handle_t* handle, uint8_t x0, uint8_t y0,
+                       uint8_t x1, uint8_t y1, pcd8544_pixel_color_t color,
+                       bool filled) {
     if (filled) {
-        for (; y0 <= y1; y0++) pcd8544_draw_line(x0, y0, x1, y0, color);
+        pcd8544_fill_area(handle, x0, y0, x1, y1, color);
+        return;
+    }
 
-    } else {
-        pcd8544_draw_line(x0, y0, x1, y0, color);  // Top
-        pcd8544_draw_line(x0, y0, x0, y1, color);  // Left
-        pcd8544_draw_line(x1, y0, x1, y1, color);  // Right
-        pcd8544_draw_line(x0, y1, x1, y1, color);  // Bottom
+    // Right and bottom edges outside the display are not drawn
+    bool right  = MAX(x0, x1) < PCD8544_H_RES_MAX;
+    bool bottom = MAX(y0, y1) < PCD8544_V_RES_MAX;
+    if (!pcd8544_clip_area(&x0, &y0, &x1, &y1)) return;
+
+    // The edges do not overlap, so XOR inverts the corners once as well
+    uint8_t top  = y0 + 1;
+    uint8_t last = bottom ? y1 - 1 : y1;
+
+    pcd8544_fill_span(handle, x0, y0, x1, y0, color);  // Top
+    if (bottom && y1 > y0)
+        pcd8544_fill_span(handle, x0, y1, x1, y1, color);  // Bottom
+    if (y1 > y0 && top <= last) {
+        pcd8544_fill_span(handle, x0, top, x0, last, color);  // Left
+        if (right && x1 > x0)
+            pcd8544_fill_span(handle, x1, top, x1, last, color);  // Right
     }
 
+    pcd8544_update_area(handle, x0, y0, x1, y1);
+}
+
+esp_err_t pcd8544_draw_rectagle(pcd8544_handle_t* handle, uint8_t x0,
+                                uint8_t y0, uint8_t x1, uint8_t y1,
+                                pcd8544_pixel_color_t color, bool filled) {
+    if (!handle) return ESP_ERR_INVALID_ARG;
+
+    PCD8544_LOCK(handle);
+    pcd8544_rectangle(handle, x0, y0, x1, y1, color, filled);
+    PCD8544_UNLOCK(handle);
     return ESP_OK;
 }
 
-esp_err_t pcd8544_draw_circle(uint8_t x0, uint8_t y0, uint8_t r,
-                              pcd8544_pixel_color_t color, bool filled) {
-    if (!g_handle) return ESP_ERR_INVALID_STATE;
+// Fill the row y0 + dy of a filled circle, rows outside the display are
+// skipped
+static void pcd8544_circle_row(pcd8544_handle_t* handle, int16_t x0,
+                               int16_t y0, int16_t dy, uint8_t half,
+                               pcd8544_pixel_color_t color) {
+    int16_t y = y0 + dy;
+
+    if (y < 0 || y >= PCD8544_V_RES_MAX) return;
+
+    pcd8544_fill_area(handle, MAX(x0 - half, 0), y,
+                      MIN(x0 + half, PCD8544_H_RES_MAX), y, color);
+}
 
+void pcd8544_circle(pcd8544_handle_t* handle, uint8_t x0, uint8_t y0, uint8_t r,
+                    pcd8544_pixel_color_t color, bool filled) {
     int16_t f     = 1 - r;
     int16_t ddF_x = 1;
     int16_t ddF_y = -2 * r;
     int16_t x     = 0;
     int16_t y     = r;
+    // Half width of every row of a filled circle, by distance from y0
+    uint8_t half[UINT8_MAX + 1];
 
-    pcd8544_draw_pixel(x0, y0 + r, color);
-    pcd8544_draw_pixel(x0, y0 - r, color);
-    pcd8544_draw_pixel(x0 + r, y0, color);
-    pcd8544_draw_pixel(x0 - r, y0, color);
-
-    if (filled)
-        pcd8544_draw_line(MAX(x0 - r, 0), y0, MIN(x0 + r, PCD8544_H_RES_MAX),
-                          y0, color);
+    if (filled) {
+        memset(half, 0, r + 1);
+        half[0] = r;
+    } else if (!r) {
+        pcd8544_plot(handle, x0, y0, color);
+        return;
+    } else {
+        pcd8544_plot(handle, x0, y0 + r, color);
+        pcd8544_plot(handle, x0, y0 - r, color);
+        pcd8544_plot(handle, x0 + r, y0, color);
+        pcd8544_plot(handle, x0 - r, y0, color);
+    }
 
     while (x < y) {
         if (f >= 0) {
@@ -485,62 +1584,319 @@ esp_err_t pcd8544_draw_circle(uint8_t x0, uint8_t y0, uint8_t r,
         f += ddF_x;
 
         if (filled) {
-            pcd8544_draw_line(MAX(x0 - x, 0), MIN(y0 + y, PCD8544_V_RES_MAX),
-                              MIN(x0 + x, PCD8544_H_RES_MAX),
-                              MIN(y0 + y, PCD8544_V_RES_MAX), color);
-            pcd8544_draw_line(MIN(x0 + x, PCD8544_H_RES_MAX), MAX(y0 - y, 0),
-                              MAX(x0 - x, 0), MAX(y0 - y, 0), color);
-
-            pcd8544_draw_line(MIN(x0 + y, PCD8544_H_RES_MAX),
-                              MIN(y0 + x, PCD8544_V_RES_MAX), MAX(x0 - y, 0),
-                              MIN(y0 + x, PCD8544_V_RES_MAX), color);
-            pcd8544_draw_line(MIN(x0 + y, PCD8544_H_RES_MAX), MAX(y0 - x, 0),
-                              MAX(x0 - y, 0), MAX(y0 - x, 0), color);
+            half[y] = MAX(half[y], x);
+            half[x] = MAX(half[x], y);
+
+        } else if (x <= y) {
+            // Past the diagonal the points repeat those of the step before,
+            // on it both octants meet. Every pixel is drawn once, for XOR.
+            pcd8544_plot(handle, x0 + x, y0 + y, color);
+            pcd8544_plot(handle, x0 - x, y0 + y, color);
+            pcd8544_plot(handle, x0 + x, y0 - y, color);
+            pcd8544_plot(handle, x0 - x, y0 - y, color);
+
+            if (x == y) continue;
+
+            pcd8544_plot(handle, x0 + y, y0 + x, color);
+            pcd8544_plot(handle, x0 - y, y0 + x, color);
+            pcd8544_plot(handle, x0 + y, y0 - x, color);
+            pcd8544_plot(handle, x0 - y, y0 - x, color);
+        }
+    }
 
-        } else {
-            pcd8544_draw_pixel(x0 + x, y0 + y, color);
-            pcd8544_draw_pixel(x0 - x, y0 + y, color);
-            pcd8544_draw_pixel(x0 + x, y0 - y, color);
-            pcd8544_draw_pixel(x0 - x, y0 - y, color);
-
-            pcd8544_draw_pixel(x0 + y, y0 + x, color);
-            pcd8544_draw_pixel(x0 - y, y0 + x, color);
-            pcd8544_draw_pixel(x0 + y, y0 - x, color);
-            pcd8544_draw_pixel(x0 - y, y0 - x, color);
+    if (!filled) return;
+
+    // Every row is filled once, as wide as the widest span of it
+    pcd8544_circle_row(handle, x0, y0, 0, half[0], color);
+    for (int16_t dy = 1; dy <= r; dy++) {
+        pcd8544_circle_row(handle, x0, y0, -dy, half[dy], color);
+        pcd8544_circle_row(handle, x0, y0, dy, half[dy], color);
+    }
+}
+
+esp_err_t pcd8544_draw_circle(pcd8544_handle_t* handle, uint8_t x0,
+                              uint8_t y0, uint8_t r,
+                              pcd8544_pixel_color_t color, bool filled) {
+    if (!handle) return ESP_ERR_INVALID_ARG;
+
+    PCD8544_LOCK(handle);
+    pcd8544_circle(handle, x0, y0, r, color, filled);
+    PCD8544_UNLOCK(handle);
+    return ESP_OK;
+}
+
+esp_err_t pcd8544_draw_bitmap(pcd8544_handle_t* handle,
+                              const uint8_t*    bitmap) {
+    if (!handle) return ESP_ERR_INVALID_ARG;
+
+    PCD8544_LOCK(handle);
+    memcpy(handle->buffer, bitmap, PCD8544_BUFFER_SIZE);
+    pcd8544_update_area(handle, 0, 0, PCD8544_H_RES_MAX - 1,
+                        PCD8544_V_RES_MAX - 1);
+    PCD8544_UNLOCK(handle);
+    return ESP_OK;
+}
+
+esp_err_t pcd8544_blit(pcd8544_handle_t* handle, int16_t x, int16_t y,
+                       uint8_t width, uint8_t height, const uint8_t* image,
+                       const uint8_t* mask) {
+    return pcd8544_blit_color(handle, x, y, width, height, image, mask,
+                              PCD8544_PIXEL_COPY);
+}
+
+esp_err_t pcd8544_blit_color(pcd8544_handle_t* handle, int16_t x, int16_t y,
+                             uint8_t width, uint8_t height,
+                             const uint8_t* image, const uint8_t* mask,
+                             pcd8544_pixel_color_t color) {
+    if (!handle || !image) return ESP_ERR_INVALID_ARG;
+
+    // Clip the image to the display, in columns of the image and pixels of
+    // the display
+    int16_t c0 = MAX(0, -x);
+    int16_t c1 = MIN(width, PCD8544_H_RES_MAX - x);
+    int16_t y0 = MAX(0, y);
+    int16_t y1 = MIN(y + height, PCD8544_V_RES_MAX) - 1;
+    if (c0 >= c1 || y0 > y1) return ESP_OK;
+
+    PCD8544_LOCK(handle);
+    for (uint8_t bank = 0; bank < (height + 7) / 8; bank++) {
+        // Each image byte lands in two display banks at most, split it there
+        // and apply both halves within the mask
+        int16_t row   = y + bank * 8;
+        uint8_t shift = ((row % 8) + 8) % 8;
+        int16_t dst   = (row - shift) / 8;
+        uint8_t rows  = height - bank * 8 < 8 ? (1 << (height - bank * 8)) - 1
+                                               : 0xFF;
+
+        const uint8_t* src = &image[bank * width];
+        const uint8_t* msk = mask ? &mask[bank * width] : NULL;
+
+        for (int16_t c = c0; c < c1; c++) {
+            uint16_t bits = src[c] << shift;
+            uint16_t keep = (msk ? msk[c] & rows : rows) << shift;
+
+            for (uint8_t half = 0; half < 2; half++, bits >>= 8, keep >>= 8) {
+                if (dst + half < 0 || dst + half >= PCD8544_BANK_NUM) continue;
+
+                pcd8544_rop(
+                    &handle->buffer[(dst + half) * PCD8544_H_RES_MAX + x + c],
+                    bits & keep, keep, color);
+            }
         }
     }
 
+    pcd8544_update_area(handle, x + c0, y0, x + c1 - 1, y1);
+    PCD8544_UNLOCK(handle);
     return ESP_OK;
 }
 
-esp_err_t pcd8544_draw_bitmap(const uint8_t* bitmap) {
-    memcpy(g_handle->buffer, bitmap, PCD8544_BUFFER_SIZE);
-    pcd8544_update_area(0, 0, PCD8544_H_RES_MAX - 1, PCD8544_V_RES_MAX - 1);
+// Shift the rows of one bank selected by mask by dx columns within x0 ~ x1.
+// Walking against the shift direction lets the bytes move in place.
+static void pcd8544_shift_bank_h(uint8_t* row, uint8_t x0, uint8_t x1,
+                                 int8_t dx, uint8_t mask) {
+    uint8_t width = x1 - x0 + 1;
+    uint8_t n     = dx > 0 ? dx : -dx;
+
+    if (mask == 0xFF) {
+        // The whole column bytes move, which is a plain memmove
+        if (dx > 0) {
+            memmove(&row[x0 + n], &row[x0], width - n);
+            memset(&row[x0], 0, n);
+        } else {
+            memmove(&row[x0], &row[x0 + n], width - n);
+            memset(&row[x1 - n + 1], 0, n);
+        }
+        return;
+    }
+
+    if (dx > 0) {
+        for (int16_t x = x1; x >= x0; x--) {
+            uint8_t bits = x - n >= x0 ? row[x - n] & mask : 0;
+            row[x]       = (row[x] & ~mask) | bits;
+        }
+    } else {
+        for (int16_t x = x0; x <= x1; x++) {
+            uint8_t bits = x + n <= x1 ? row[x + n] & mask : 0;
+            row[x]       = (row[x] & ~mask) | bits;
+        }
+    }
+}
+
+// Shift the rows y0 ~ y1 of column x by dy. The 6 bytes of a column are
+// gathered into one word, so the bits cross bank boundaries in a single shift.
+static void pcd8544_shift_column_v(uint8_t* buffer, uint8_t x, uint8_t b0,
+                                   uint8_t b1, uint64_t mask, int8_t dy) {
+    uint64_t col = 0;
+
+    for (uint8_t i = b0; i <= b1; i++)
+        col |= (uint64_t)buffer[i * PCD8544_H_RES_MAX + x] << (8 * i);
+
+    uint64_t rows  = col & mask;
+    uint64_t moved = dy > 0 ? rows << dy : rows >> -dy;
+    col            = (col & ~mask) | (moved & mask);
+
+    for (uint8_t i = b0; i <= b1; i++)
+        buffer[i * PCD8544_H_RES_MAX + x] = col >> (8 * i);
+}
+
+// Move the whole banks b0 ~ b1 by n banks within columns x0 ~ x1, a row of
+// bytes at a time. Walking against the shift direction lets the rows move in
+// place.
+static void pcd8544_shift_banks_v(uint8_t* buffer, uint8_t x0, uint8_t x1,
+                                  uint8_t b0, uint8_t b1, int8_t n) {
+    uint8_t width = x1 - x0 + 1;
+
+    for (uint8_t k = 0; k <= b1 - b0; k++) {
+        uint8_t  dst = n > 0 ? b1 - k : b0 + k;
+        int8_t   src = dst - n;
+        uint8_t* row = &buffer[dst * PCD8544_H_RES_MAX + x0];
+
+        if (src < b0 || src > b1)
+            memset(row, 0, width);
+        else
+            memcpy(row, &buffer[src * PCD8544_H_RES_MAX + x0], width);
+    }
+}
+
+void pcd8544_shift_area(pcd8544_handle_t* handle, uint8_t x0, uint8_t y0,
+                        uint8_t x1, uint8_t y1, int8_t dx, int8_t dy) {
+    if (!pcd8544_clip_area(&x0, &y0, &x1, &y1)) return;
+
+    // Everything is shifted out of the area
+    if (abs(dx) > x1 - x0 || abs(dy) > y1 - y0) {
+        pcd8544_fill_area(handle, x0, y0, x1, y1, PCD8544_PIXEL_WHITE);
+        return;
+    }
+
+    if (dx) {
+        for (uint8_t i = y0 / 8; i <= y1 / 8; i++) {
+            uint8_t mask = 0xFF;
+
+            if (i == y0 / 8) mask &= 0xFF << (y0 % 8);
+            if (i == y1 / 8) mask &= 0xFF >> (7 - (y1 % 8));
+
+            pcd8544_shift_bank_h(&handle->buffer[i * PCD8544_H_RES_MAX], x0,
+                                 x1, dx, mask);
+        }
+    }
+
+    if (dy && dy % 8 == 0 && y0 % 8 == 0 && y1 % 8 == 7) {
+        // The area is made of whole banks and moves by whole banks
+        pcd8544_shift_banks_v(handle->buffer, x0, x1, y0 / 8, y1 / 8, dy / 8);
+    } else if (dy) {
+        uint64_t mask = ((2ULL << y1) - 1) & ~((1ULL << y0) - 1);
+
+        for (uint8_t x = x0; x <= x1; x++)
+            pcd8544_shift_column_v(handle->buffer, x, y0 / 8, y1 / 8, mask,
+                                   dy);
+    }
+
+    pcd8544_update_area(handle, x0, y0, x1, y1);
+}
+
+esp_err_t pcd8544_scroll_area(pcd8544_handle_t* handle, uint8_t x0,
+                              uint8_t y0, uint8_t x1, uint8_t y1, int8_t dx,
+                              int8_t dy) {
+    if (!handle) return ESP_ERR_INVALID_ARG;
+
+    PCD8544_LOCK(handle);
+    pcd8544_shift_area(handle, x0, y0, x1, y1, dx, dy);
+    PCD8544_UNLOCK(handle);
     return ESP_OK;
 }
 
-esp_err_t pcd8544_scroll(int8_t dx, int8_t dy) {
-    uint8_t temp_buffer[PCD8544_BUFFER_SIZE];
-    memcpy(temp_buffer, g_handle->buffer, PCD8544_BUFFER_SIZE);
-    memset(g_handle->buffer, 0, PCD8544_BUFFER_SIZE);
+esp_err_t pcd8544_scroll(pcd8544_handle_t* handle, int8_t dx, int8_t dy) {
+    esp_err_t ret = pcd8544_scroll_area(handle, 0, 0, PCD8544_H_RES_MAX - 1,
+                                        PCD8544_V_RES_MAX - 1, dx, dy);
+    if (ret != ESP_OK) return ret;
+
+    return pcd8544_flush(handle);
+}
 
-    for (uint8_t x = 0; x < PCD8544_H_RES_MAX; x++) {
-        for (uint8_t y = 0; y < PCD8544_V_RES_MAX; y++) {
-            if (temp_buffer[x + (y / 8) * PCD8544_H_RES_MAX] & (1 << y % 8)) {
-                uint8_t new_x = x + dx;
-                uint8_t new_y = y + dy;
-                pcd8544_draw_pixel(new_x, new_y, PCD8544_PIXEL_BLACK);
+// Animation task of pcd8544_scroll_smooth(). Each frame it works out how far
+// the scroll should be by now and moves the rest of the way, so a flush that
+// takes longer than a frame is caught up with a larger step instead of
+// stretching the animation.
+static void pcd8544_scroll_task(void* arg) {
+    pcd8544_handle_t* handle = arg;
+    int8_t            dx     = handle->scroll_dx;
+    int8_t            dy     = handle->scroll_dy;
+    int32_t           steps  = MAX(abs(dx), abs(dy));
+    int64_t           time   = (int64_t)handle->scroll_time_ms * 1000;
+    int64_t           start  = esp_timer_get_time();
+    int8_t            done_x = 0, done_y = 0;
+    int32_t           step   = 0;
+
+    // One frame per pixel step at most, but never faster than a tick
+    TickType_t period =
+        MAX(pdMS_TO_TICKS(handle->scroll_time_ms / steps), (TickType_t)1);
+    TickType_t wake = xTaskGetTickCount();
+
+    while (step < steps) {
+        int64_t elapsed = esp_timer_get_time() - start;
+
+        step = elapsed >= time ? steps : (int32_t)(steps * elapsed / time);
+        if (step) {
+            int8_t x = dx * step / steps;
+            int8_t y = dy * step / steps;
+
+            // Each step is shifted and flushed as a whole, drawing and
+            // flushes of other tasks go before or after it
+            if (x != done_x || y != done_y) {
+                xSemaphoreTakeRecursive(handle->lock, portMAX_DELAY);
+                pcd8544_scroll(handle, x - done_x, y - done_y);
+                xSemaphoreGiveRecursive(handle->lock);
+                done_x = x;
+                done_y = y;
             }
         }
+
+        if (step < steps) vTaskDelayUntil(&wake, period);
+    }
+
+    xSemaphoreGive(handle->scroll_idle);
+    vTaskDelete(NULL);
+}
+
+esp_err_t pcd8544_scroll_smooth(pcd8544_handle_t* handle, int8_t dx,
+                                int8_t dy, int max_scroll_time_ms) {
+    if (!handle || max_scroll_time_ms < 0) return ESP_ERR_INVALID_ARG;
+
+    // Nothing to animate
+    if ((!dx && !dy) || !max_scroll_time_ms)
+        return pcd8544_scroll(handle, dx, dy);
+
+    if (!handle->scroll_idle) {
+        handle->scroll_idle = xSemaphoreCreateBinary();
+        if (!handle->scroll_idle) return ESP_ERR_NO_MEM;
+        xSemaphoreGive(handle->scroll_idle);
+    }
+
+    if (xSemaphoreTake(handle->scroll_idle, 0) != pdTRUE)
+        return ESP_ERR_INVALID_STATE;
+
+    handle->scroll_dx      = dx;
+    handle->scroll_dy      = dy;
+    handle->scroll_time_ms = max_scroll_time_ms;
+
+    if (xTaskCreate(pcd8544_scroll_task, "pcd8544_scroll",
+                    PCD8544_SCROLL_TASK_STACK, handle,
+                    PCD8544_SCROLL_TASK_PRIO, NULL) != pdPASS) {
+        xSemaphoreGive(handle->scroll_idle);
+        return ESP_ERR_NO_MEM;
     }
 
-    pcd8544_update_area(0, 0, PCD8544_H_RES_MAX - 1, PCD8544_V_RES_MAX - 1);
-    pcd8544_flush();
     return ESP_OK;
 }
 
-// esp_err_t pcd8544_scroll_smooth(uint8_t dx, uint8_t dy,
-//                                 int max_scroll_time_ms) {
-//     // TODO: smooth scrolling animation
-//     return ESP_OK;
-// }
\ No newline at end of file
+esp_err_t pcd8544_scroll_smooth_wait(pcd8544_handle_t* handle,
+                                     TickType_t        ticks_to_wait) {
+    if (!handle) return ESP_ERR_INVALID_ARG;
+    if (!handle->scroll_idle) return ESP_OK;
+
+    if (xSemaphoreTake(handle->scroll_idle, ticks_to_wait) != pdTRUE)
+        return ESP_ERR_TIMEOUT;
+
+    xSemaphoreGive(handle->scroll_idle);
+    return ESP_OK;
+}
@@ -44,11 +44,94 @@ typedef enum {
     PCD8544_FONT_5x7, /*!< Font 5x7 */
 } pcd8544_font_t;
 
+/**
+ * @brief Pixel color, which is also the raster operation of a drawing call.
+ *
+ * White and black clear and set the pixels drawn and leave the others as
+ * they are. XOR inverts the pixels drawn, so drawing the same again restores
+ * what was there, as for a cursor or a selection. Copy draws glyphs and
+ * images with their background: the pixels of the glyph cell or the image
+ * that are not set are cleared. For pixels, lines and shapes copy is black.
+ */
 typedef enum {
     PCD8544_PIXEL_WHITE, /*!< Pixel color white */
     PCD8544_PIXEL_BLACK, /*!< Pixel color black */
+    PCD8544_PIXEL_XOR,   /*!< Invert the pixels drawn */
+    PCD8544_PIXEL_COPY,  /*!< Black on a white background */
 } pcd8544_pixel_color_t;
 
+// Tallest glyph of a font descriptor, in rows
+#define PCD8544_FONT_HEIGHT_MAX 32
+
+typedef struct {
+    uint16_t offset;  /*!< First bit of the glyph in the font bitmap */
+    uint8_t  width;   /*!< Columns of the glyph, 0 for a blank one */
+    uint8_t  advance; /*!< Cursor advance, spacing included */
+} pcd8544_glyph_t;
+
+typedef struct {
+    uint16_t first; /*!< First code point of the range */
+    uint16_t last;  /*!< Last code point of the range */
+    uint16_t glyph; /*!< Glyph table entry of the first code point */
+} pcd8544_glyph_range_t;
+
+/**
+ * @brief Font descriptor, see pcd8544_putc_font().
+ *
+ * The bitmap holds the glyph columns from left to right, every column stride
+ * bits with its top row first, as one stream of bits running from bit 0 of
+ * bitmap[0] up. With stride equal to height the columns are packed without
+ * gaps, as made by pcd8544_font.py; a stride of 8 is the column byte layout
+ * of the display.
+ *
+ * The glyph table is indexed by first ~ last, or, for sparse fonts like
+ * Latin-1, Cyrillic or Vietnamese subsets, by sorted ranges of code points
+ * that are looked up by binary search.
+ */
+typedef struct {
+    const uint8_t*               bitmap;    /*!< Glyph columns */
+    const pcd8544_glyph_t*       glyphs;    /*!< Glyph table, NULL when all
+                                                 glyphs are width columns and
+                                                 follow one another */
+    const pcd8544_glyph_range_t* ranges;    /*!< Sorted code point ranges of
+                                                 the glyph table, NULL for
+                                                 first ~ last */
+    uint16_t                     range_num; /*!< Number of ranges */
+    uint8_t                      first;     /*!< First character */
+    uint8_t                      last;      /*!< Last character */
+    uint8_t                      width;     /*!< Glyph columns without a glyph
+                                                 table, the cursor advances
+                                                 one more */
+    uint8_t                      height;    /*!< Glyph rows, 1 ~ 32, also the
+                                                 line height */
+    uint8_t                      stride;    /*!< Bits of every column in the
+                                                 bitmap, >= height */
+} pcd8544_font_desc_t;
+
+/**
+ * @brief Layout flags of pcd8544_draw_text_box(), one horizontal and one
+ * vertical alignment OR-ed with PCD8544_TEXT_WRAP if needed.
+ */
+typedef enum {
+    PCD8544_ALIGN_LEFT   = 0x00, /*!< Lines start at the left of the box */
+    PCD8544_ALIGN_CENTER = 0x01, /*!< Lines are centred in the box */
+    PCD8544_ALIGN_RIGHT  = 0x02, /*!< Lines end at the right of the box */
+    PCD8544_ALIGN_TOP    = 0x00, /*!< Text starts at the top of the box */
+    PCD8544_ALIGN_MIDDLE = 0x04, /*!< Text is centred in the box */
+    PCD8544_ALIGN_BOTTOM = 0x08, /*!< Text ends at the bottom of the box */
+    PCD8544_TEXT_WRAP    = 0x10, /*!< Break lines wider than the box */
+} pcd8544_text_flags_t;
+
+// Fonts of PCD8544_FONT_3x5 and PCD8544_FONT_5x7
+extern const pcd8544_font_desc_t pcd8544_font_3x5;
+extern const pcd8544_font_desc_t pcd8544_font_5x7;
+// The 5x7 glyphs without their blank columns, with Latin-1 letters of
+// Western European languages
+extern const pcd8544_font_desc_t pcd8544_font_5x7_prop;
+// Digits and " +-.:" for big numbers, in 8 x 16 and 12 x 24 cells
+extern const pcd8544_font_desc_t pcd8544_font_8x16_digits;
+extern const pcd8544_font_desc_t pcd8544_font_12x24_digits;
+
 typedef struct {
     int rst_gpio_num; /*!< GPIO used for resetting the display */
     int ce_gpio_num;  /*!< GPIO used for CE line */
@@ -62,109 +145,348 @@ typedef struct {
     } flags;                         /*!< Extra flags to fine-tune the device */
 } pcd8544_io_config_t;
 
+/**
+ * @brief Opaque handle of one display, created by pcd8544_init().
+ */
+typedef struct pcd8544_handle_t pcd8544_handle_t;
+
+/**
+ * @brief Opaque display list, created by pcd8544_dlist_create().
+ */
+typedef struct pcd8544_dlist_t pcd8544_dlist_t;
+
+/**
+ * @brief Opaque screen template, created by pcd8544_template_create().
+ */
+typedef struct pcd8544_template_t pcd8544_template_t;
+
+// Largest value of a template field, in bytes
+#define PCD8544_FIELD_VALUE_MAX 32
+
+/**
+ * @brief Draw callback of a template field.
+ *
+ * Called with the display still locked by pcd8544_draw_template(), draw the
+ * value with the usual drawing calls and stay inside the area of the field.
+ *
+ * @param[in] handle Display handle.
+ *
+ * @param[in] value Value last given to pcd8544_template_set_field().
+ *
+ * @param[in] len Length of the value in bytes, 0 when none is set yet.
+ *
+ * @param[in] user_ctx User context given to pcd8544_template_add_field().
+ */
+typedef void (*pcd8544_field_draw_cb_t)(pcd8544_handle_t* handle,
+                                        const void* value, size_t len,
+                                        void* user_ctx);
+
+typedef struct {
+    const uint8_t* data;        /*!< Encoded frame, see pcd8544_draw_rle() */
+    size_t         len;         /*!< Length of the encoded frame in bytes */
+    uint32_t       duration_ms; /*!< Time the frame stays on the display */
+} pcd8544_anim_frame_t;
+
+typedef struct {
+    const pcd8544_anim_frame_t* frames;    /*!< Frames, in order */
+    size_t                      frame_num; /*!< Number of frames */
+    bool delta; /*!< Frames after the first only hold what changed from the
+                     frame before, as made by pcd8544_encode.py --delta */
+} pcd8544_anim_t;
+
+/**
+ * @brief Opaque text console, created by pcd8544_console_create().
+ */
+typedef struct pcd8544_console_t pcd8544_console_t;
+
+typedef struct {
+    pcd8544_font_t font; /*!< Font of the console text */
+    uint8_t        y;    /*!< Y-coordinates of the console top */
+    uint8_t        rows; /*!< Text rows, 0 for as many as fit below y */
+} pcd8544_console_config_t;
+
+typedef struct {
+    uint32_t transactions; /*!< SPI transactions sent to the display */
+    uint32_t cmd_bytes;    /*!< Command bytes sent (D/C low) */
+    uint32_t data_bytes;   /*!< Display RAM bytes sent (D/C high) */
+    uint32_t flushes;      /*!< Flushes that transferred a dirty area */
+} pcd8544_stats_t;
+
+/**
+ * @brief Async flush completion callback.
+ *
+ * @note Called from the SPI interrupt, keep it short and ISR safe.
+ *
+ * @param[in] user_ctx User context given to pcd8544_flush_async().
+ */
+typedef void (*pcd8544_flush_done_cb_t)(void* user_ctx);
+
 /**
  * @brief Initialize the display and enter into normal mode.
  *
+ * @note Several displays can share one SPI host, each one on its own CE line.
+ * The backlights of all displays share one LEDC timer.
+ *
  * @param[in] spi_host The SPI host used for LCD.
  *
  * @param[in] io_config Pointer of LCD gpio configuration.
  *
+ * @param[out] ret_handle Pointer of the returned display handle.
+ *
  * @return
  *      - ESP_OK on success.
- *      - ESP_ERR_INVALID_STATE if the display has already initialized.
  *      - ESP_ERR_INVALID_ARG if parameter is invalid.
+ *      - ESP_ERR_NO_MEM if the handle can not be allocated.
+ *      - Error of spi_bus_add_device() if the device can not be added.
  */
 esp_err_t pcd8544_init(const spi_host_device_t    spi_host,
-                       const pcd8544_io_config_t* io_config);
+                       const pcd8544_io_config_t* io_config,
+                       pcd8544_handle_t**         ret_handle);
 
 /**
  * @brief Deinitialize the display.
  *
+ * @param[in] handle Display handle.
+ *
  * @return
  *      - ESP_OK on success.
- *      - ESP_ERR_INVALID_STATE if:
- *              1. The display has already deinitialized.
- *              2. The display was not initialized yet.
+ *      - ESP_ERR_INVALID_ARG if handle is NULL.
  */
-esp_err_t pcd8544_deinit(void);
+esp_err_t pcd8544_deinit(pcd8544_handle_t* handle);
 
 /**
- * @brief Clear the display.
+ * @brief Clear the buffer. Call pcd8544_flush() to update the display.
+ *
+ * @note Only bytes that differ from what the display already shows are sent
+ * by the next flush, so clearing and redrawing a whole screen every frame
+ * costs no more than the actual change.
+ *
+ * @param[in] handle Display handle.
  *
  * @return
  *      - ESP_OK on success.
- *      - ESP_ERR_INVALID_STATE if:
- *              1. The display has already deinitialized.
- *              2. The display was not initialized yet.
+ *      - ESP_ERR_INVALID_ARG if handle is NULL.
  */
-esp_err_t pcd8544_clear(void);
+esp_err_t pcd8544_clear(pcd8544_handle_t* handle);
 
 /**
  * @brief Update the display by flushing buffer.
  *
+ * @note Only the bytes that differ from the last flushed frame are sent.
+ * Unchanged gaps shorter than the cost of re-addressing the controller are
+ * streamed rather than skipped (see PCD8544_TRANS_OVERHEAD_BYTES).
+ * While the render task runs, the update is left to its next frame.
+ *
+ * @note Any task can flush, flushes of the same display are sent one after
+ * the other. Drawing is only held up while the changes are picked up, not
+ * while they are transferred.
+ *
+ * @param[in] handle Display handle.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if handle is NULL.
+ *      - Error of the SPI driver if a transfer fails. The next flush sends
+ *        the whole buffer again then.
+ */
+esp_err_t pcd8544_flush(pcd8544_handle_t* handle);
+
+/**
+ * @brief Update the display in the background.
+ *
+ * The changed area is copied into a second frame buffer and queued on the SPI
+ * device, so drawing into the buffer can go on while it is transferred.
+ * A new flush waits for the previous one to be done first.
+ *
+ * @param[in] handle Display handle.
+ *
+ * @param[in] cb Callback when the transfer is done, can be NULL. It is called
+ * right away when nothing needs to be updated.
+ *
+ * @param[in] user_ctx User context passed to the callback.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if handle is NULL.
+ *      - ESP_ERR_INVALID_STATE if the render task of the display runs.
+ *      - Error of the SPI driver if a transfer can not be queued. What was
+ *        queued before is still sent, the callback is not called, and the
+ *        next flush sends the whole buffer again.
+ */
+esp_err_t pcd8544_flush_async(pcd8544_handle_t*       handle,
+                              pcd8544_flush_done_cb_t cb, void* user_ctx);
+
+/**
+ * @brief Wait for an async flush to be done.
+ *
+ * @param[in] handle Display handle.
+ *
+ * @param[in] ticks_to_wait Ticks to wait, portMAX_DELAY to wait forever.
+ *
+ * @return
+ *      - ESP_OK on success, or if no flush is pending.
+ *      - ESP_ERR_TIMEOUT if the transfer is not done in time.
+ *      - ESP_ERR_INVALID_ARG if handle is NULL.
+ */
+esp_err_t pcd8544_flush_wait(pcd8544_handle_t* handle,
+                             TickType_t        ticks_to_wait);
+
+/**
+ * @brief Update several displays on the same bus in one go.
+ *
+ * The changed areas of all displays are queued before any of them is waited
+ * for, so the transfers run back to back. Returns when all are done.
+ *
+ * @param[in] handles Array of display handles.
+ *
+ * @param[in] num Number of handles.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if handles or one of its entries is NULL.
+ *      - ESP_ERR_INVALID_STATE if the render task of one of the displays
+ *        runs, nothing is flushed then.
+ *      - The first error of pcd8544_flush_async() or pcd8544_flush_wait().
+ *        The displays after one that fails to queue are not flushed, the
+ *        ones before it are still waited for.
+ */
+esp_err_t pcd8544_flush_multi(pcd8544_handle_t* const handles[], size_t num);
+
+/**
+ * @brief Start the render task of the display.
+ *
+ * The task flushes the changes of the buffer at most
+ * CONFIG_PCD8544_RENDER_FPS times per second. While it runs,
+ * pcd8544_flush() returns right away and leaves the transfer to the next
+ * frame, so everything drawn in between goes out as one flush.
+ * pcd8544_flush_async() and pcd8544_flush_multi() can not be used with it.
+ *
+ * @param[in] handle Display handle.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if handle is NULL.
+ *      - ESP_ERR_INVALID_STATE if the render task is already running.
+ *      - ESP_ERR_NO_MEM if the task can not be created.
+ */
+esp_err_t pcd8544_render_start(pcd8544_handle_t* handle);
+
+/**
+ * @brief Stop the render task and flush what is left.
+ *
+ * @param[in] handle Display handle.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if handle is NULL.
+ *      - ESP_ERR_INVALID_STATE if the render task is not running.
+ *      - Error of the SPI driver if the last flush fails.
+ */
+esp_err_t pcd8544_render_stop(pcd8544_handle_t* handle);
+
+/**
+ * @brief Wait for the render task to finish its next frame.
+ *
+ * @note Any number of tasks can wait at the same time.
+ *
+ * @param[in] handle Display handle.
+ *
+ * @param[in] ticks_to_wait Ticks to wait, portMAX_DELAY to wait forever.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if handle is NULL.
+ *      - ESP_ERR_INVALID_STATE if the render task is not running.
+ *      - ESP_ERR_TIMEOUT if no frame is done in time.
+ */
+esp_err_t pcd8544_wait_vsync(pcd8544_handle_t* handle,
+                             TickType_t        ticks_to_wait);
+
+/**
+ * @brief Get the bus statistics collected since init or the last reset.
+ *
+ * @note Counts are kept by the driver itself, so they are also available when
+ * the driver runs without real hardware.
+ *
+ * @param[in] handle Display handle.
+ *
+ * @param[out] stats Pointer of the output statistics.
+ *
  * @return
  *      - ESP_OK on success.
- *      - ESP_ERR_INVALID_STATE if:
- *              1. The display has already deinitialized.
- *              2. The display was not initialized yet.
+ *      - ESP_ERR_INVALID_ARG if handle or stats is NULL.
  */
-esp_err_t pcd8544_flush(void);
+esp_err_t pcd8544_get_stats(pcd8544_handle_t* handle, pcd8544_stats_t* stats);
+
+/**
+ * @brief Reset the bus statistics.
+ *
+ * @param[in] handle Display handle.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if handle is NULL.
+ */
+esp_err_t pcd8544_reset_stats(pcd8544_handle_t* handle);
 
 /**
  * @brief Set display invert control.
  *
+ * @param[in] handle Display handle.
+ *
  * @param[in] invert Whether to invert the display color.
  *
  * @return
  *      - ESP_OK on success.
- *      - ESP_ERR_INVALID_STATE if:
- *              1. The display has already deinitialized.
- *              2. The display was not initialized yet.
+ *      - ESP_ERR_INVALID_ARG if handle is NULL.
  */
-esp_err_t pcd8544_invert(bool invert);
+esp_err_t pcd8544_invert(pcd8544_handle_t* handle, bool invert);
 
 /**
  * @brief Check if the display is inverted.
  *
+ * @param[in] handle Display handle.
+ *
  * @param[out] inverted Pointer of the output result.
  *
  * @return
  *      - ESP_OK on success.
- *      - ESP_ERR_INVALID_STATE if:
- *              1. The display has already deinitialized.
- *              2. The display was not initialized yet.
+ *      - ESP_ERR_INVALID_ARG if handle is NULL.
  */
-esp_err_t pcd8544_is_inverted(bool* inverted);
+esp_err_t pcd8544_is_inverted(pcd8544_handle_t* handle, bool* inverted);
 
 /**
  * @brief Set the contrast level.
  *
+ * @param[in] handle Display handle.
+ *
  * @param[in] contrast Contrast value to be set (range: 0x00 ~ 0x7F).
  *
  * @return
  *      - ESP_OK on success.
- *      - ESP_ERR_INVALID_STATE if:
- *              1. The display has already deinitialized.
- *              2. The display was not initialized yet.
+ *      - ESP_ERR_INVALID_ARG if handle is NULL.
  */
-esp_err_t pcd8544_set_contrast(uint8_t contrast);
+esp_err_t pcd8544_set_contrast(pcd8544_handle_t* handle, uint8_t contrast);
 
 /**
  * @brief Set backlight brightness.
  *
+ * @param[in] handle Display handle.
+ *
  * @param[in] brightness Brightness percentage (range: 0 ~ 100).
  *
  * @return
  *      - ESP_OK on success.
- *      - ESP_ERR_INVALID_STATE if:
- *              1. The display has already deinitialized.
- *              2. The display was not initialized yet.
+ *      - ESP_ERR_INVALID_ARG if handle is NULL.
+ *      - ESP_ERR_INVALID_STATE if the display has no backlight.
  */
-esp_err_t pcd8544_set_backlight(uint8_t brightness);
+esp_err_t pcd8544_set_backlight(pcd8544_handle_t* handle, uint8_t brightness);
 
 /**
  * @brief Backlight fade function, with a limited time.
  *
+ * @param[in] handle Display handle.
+ *
  * @param[in] brightness Brightness percentage (range 0 ~ 100)
  *
  * @param[in] max_fade_time_ms The maximum time of the fading in miliseconds.
@@ -172,30 +494,89 @@ esp_err_t pcd8544_set_backlight(uint8_t brightness);
  * @param[in] wait_fade_done Whether to block until fading done.
  *
  * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if handle is NULL.
+ *      - ESP_ERR_INVALID_STATE if the display has no backlight.
  */
-esp_err_t pcd8544_set_backlight_fade(uint8_t brightness, int max_fade_time_ms,
+esp_err_t pcd8544_set_backlight_fade(pcd8544_handle_t* handle,
+                                     uint8_t brightness, int max_fade_time_ms,
                                      bool wait_fade_done);
 
+/**
+ * @brief Lock the display for a batch of drawing calls.
+ *
+ * Other tasks can not draw into the display, and a flush does not take a
+ * snapshot of the buffer, until pcd8544_end() is called. The lock is
+ * recursive, begin / end pairs can be nested.
+ *
+ * @note Drawing calls only lock the display by themselves with
+ * CONFIG_PCD8544_LOCK_EACH_CALL. Without it, use begin / end around every
+ * drawing that can run at the same time as drawing from another task.
+ *
+ * @param[in] handle Display handle.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if handle is NULL.
+ */
+esp_err_t pcd8544_begin(pcd8544_handle_t* handle);
+
+/**
+ * @brief Unlock the display after pcd8544_begin().
+ *
+ * @param[in] handle Display handle.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if handle is NULL.
+ *      - ESP_ERR_INVALID_STATE if the calling task does not hold the lock.
+ */
+esp_err_t pcd8544_end(pcd8544_handle_t* handle);
+
 /**
  * @brief Set the cursor coordinate.
  *
  * @note The origin of coordinates (x = 0, y = 0) is at the display's top left.
  *
+ * @param[in] handle Display handle.
+ *
  * @param[in] x X-coordinates (horizontal lines).
  *
  * @param[in] y Y-coordinates (vertical lines).
  *
  * @return
  *      - ESP_OK on success.
- *      - ESP_ERR_INVALID_STATE if:
- *              1. The display has already deinitialized.
- *              2. The display was not initialized yet.
+ *      - ESP_ERR_INVALID_ARG if handle is NULL.
+ */
+esp_err_t pcd8544_goto_xy(pcd8544_handle_t* handle, uint8_t x, uint8_t y);
+
+/**
+ * @brief Write characters straight to the display.
+ *
+ * In terminal mode, characters of the 5x7 font drawn at a y that is a
+ * multiple of 8 are sent to the display right away as 6 bytes, and need no
+ * flush. The buffer is updated as well, every color draws the same as it does
+ * into the buffer. Other fonts and rows are drawn into the buffer as usual.
+ *
+ * @note Characters go through the buffer as usual before the first flush and
+ * while the render task runs. A character waits for a flush of another task
+ * to be sent before it is written.
+ *
+ * @param[in] handle Display handle.
+ *
+ * @param[in] enable Whether to enable terminal mode.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if handle is NULL.
  */
-esp_err_t pcd8544_goto_xy(uint8_t x, uint8_t y);
+esp_err_t pcd8544_set_terminal_mode(pcd8544_handle_t* handle, bool enable);
 
 /**
  * @brief Draw a character into the buffer.
  *
+ * @param[in] handle Display handle.
+ *
  * @param[in] font Font size.
  *
  * @param[in] color Pixel color.
@@ -204,161 +585,1080 @@ esp_err_t pcd8544_goto_xy(uint8_t x, uint8_t y);
  *
  * @return
  *      - ESP_OK on success.
- *      - ESP_ERR_INVALID_STATE if:
- *              1. The display has already deinitialized.
- *              2. The display was not initialized yet.
+ *      - ESP_ERR_INVALID_ARG if handle is NULL, or font is not one of
+ *        pcd8544_font_t.
  */
-esp_err_t pcd8544_putc(pcd8544_font_t font, pcd8544_pixel_color_t color,
-                       char c);
+esp_err_t pcd8544_putc(pcd8544_handle_t* handle, pcd8544_font_t font,
+                       pcd8544_pixel_color_t color, char c);
 
 /**
  * @brief Draw a string into the buffer.
  *
+ * The string is UTF-8. The two fonts only have glyphs for printable ASCII,
+ * other characters are skipped; see pcd8544_puts_font() for more.
+ *
+ * @param[in] handle Display handle.
+ *
  * @param[in] font Font size.
  *
  * @param[in] color Pixel color.
  *
- * @param[in] format Format of the string. See printf().
+ * @param[in] format Format of the string, see pcd8544_puts_font().
  *
  * @return
  *      - ESP_OK on success.
- *      - ESP_ERR_INVALID_STATE if:
- *              1. The display has already deinitialized.
- *              2. The display was not initialized yet.
+ *      - ESP_ERR_INVALID_ARG if handle or format is NULL, or font is not one
+ *        of pcd8544_font_t.
  */
-esp_err_t pcd8544_puts(pcd8544_font_t font, pcd8544_pixel_color_t color,
-                       const char* format, ...)
-    __attribute__((format(printf, 3, 4)));
+esp_err_t pcd8544_puts(pcd8544_handle_t* handle, pcd8544_font_t font,
+                       pcd8544_pixel_color_t color, const char* format, ...)
+    __attribute__((format(printf, 4, 5)));
 
 /**
- * @brief Draw a pixel into the buffer.
+ * @brief Draw a character of a font descriptor into the buffer.
  *
- * @param[in] x X-coordinates (horizontal lines).
+ * The glyph is drawn with its top left corner at the cursor, which then
+ * advances by the glyph advance. Like with pcd8544_putc(), a glyph that does
+ * not fit on the line goes to the start of the next one, font->height rows
+ * down. Glyphs taller than 8 rows span several banks. Characters the font
+ * has no glyph for are skipped.
  *
- * @param[in] y Y-coordinates (vertical lines).
+ * @param[in] handle Display handle.
+ *
+ * @param[in] font Font descriptor.
  *
  * @param[in] color Pixel color.
  *
+ * @param[in] code Unicode code point of the character.
+ *
  * @return
  *      - ESP_OK on success.
- *      - ESP_ERR_INVALID_ARG if the coordinates is out of display resolution.
- *      - ESP_ERR_INVALID_STATE if:
- *              1. The display has already deinitialized.
- *              2. The display was not initialized yet.
+ *      - ESP_ERR_INVALID_ARG if handle or font is NULL, or the font height
+ *        is not 1 ~ PCD8544_FONT_HEIGHT_MAX.
  */
-esp_err_t pcd8544_draw_pixel(uint8_t x, uint8_t y, pcd8544_pixel_color_t color);
+esp_err_t pcd8544_putc_font(pcd8544_handle_t*          handle,
+                            const pcd8544_font_desc_t* font,
+                            pcd8544_pixel_color_t color, uint32_t code);
 
 /**
- * @brief Draw a line into the buffer.
+ * @brief Draw a string of a font descriptor into the buffer.
  *
- * @param[in] x0 The start X-coordinates (horizontal lines).
+ * The string is UTF-8, malformed sequences are drawn as U+FFFD when the font
+ * has a glyph for it.
  *
- * @param[in] y0 The start Y-coordinates (vertical lines).
+ * Characters are drawn as they are formatted, without a buffer in between,
+ * so the string has no length limit. The format takes the flags, width,
+ * precision and length modifiers of printf() with the d, i, u, x, X, o, p,
+ * c, s and % conversions, and f and F with at most 9 decimals when
+ * CONFIG_PCD8544_FORMAT_FLOAT is set. A long double (%Lf) is narrowed to a
+ * double. Other conversions, like e, g, a and n, are drawn as they are
+ * written and their argument is skipped.
  *
- * @param[in] x1 The end X-coordinates (horizontal lines).
+ * @param[in] handle Display handle.
  *
- * @param[in] y1 The end Y-coordinates (vertical lines).
+ * @param[in] font Font descriptor, see pcd8544_putc_font().
  *
  * @param[in] color Pixel color.
  *
+ * @param[in] format Format of the string.
+ *
  * @return
  *      - ESP_OK on success.
- *      - ESP_ERR_INVALID_STATE if:
- *              1. The display has already deinitialized.
- *              2. The display was not initialized yet.
+ *      - ESP_ERR_INVALID_ARG if handle, font or format is NULL, or the font
+ *        height is not 1 ~ PCD8544_FONT_HEIGHT_MAX.
  */
-esp_err_t pcd8544_draw_line(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1,
-                            pcd8544_pixel_color_t color);
+esp_err_t pcd8544_puts_font(pcd8544_handle_t*          handle,
+                            const pcd8544_font_desc_t* font,
+                            pcd8544_pixel_color_t color, const char* format,
+                            ...) __attribute__((format(printf, 4, 5)));
 
 /**
- * @brief Draw a rectangle into the buffer.
- *
- * @param[in] x0 The start X-coordinates (horizontal lines).
+ * @brief Draw an integer into the buffer.
  *
- * @param[in] y0 The start Y-coordinates (vertical lines).
+ * A numeric field without a format string: the number is drawn right
+ * aligned in width characters, padded with pad on the left. With pad '0' the
+ * minus sign goes before the zeros. A number longer than width is drawn
+ * whole.
  *
- * @param[in] x1 The end X-coordinates (horizontal lines).
+ * @param[in] handle Display handle.
  *
- * @param[in] y1 The end Y-coordinates (vertical lines).
+ * @param[in] font Font descriptor, see pcd8544_putc_font().
  *
  * @param[in] color Pixel color.
  *
- * @param[in] filled Whether to fill the shape.
+ * @param[in] value Number to draw.
+ *
+ * @param[in] width Width of the field in characters, 0 for none.
+ *
+ * @param[in] pad Padding character, usually ' ' or '0'.
  *
  * @return
  *      - ESP_OK on success.
- *      - ESP_ERR_INVALID_STATE if:
- *              1. The display has already deinitialized.
- *              2. The display was not initialized yet.
+ *      - ESP_ERR_INVALID_ARG if handle or font is NULL, or the font height
+ *        is not 1 ~ PCD8544_FONT_HEIGHT_MAX.
  */
-esp_err_t pcd8544_draw_rectagle(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1,
-                                pcd8544_pixel_color_t color, bool filled);
+esp_err_t pcd8544_put_int(pcd8544_handle_t*          handle,
+                          const pcd8544_font_desc_t* font,
+                          pcd8544_pixel_color_t color, int32_t value,
+                          uint8_t width, char pad);
 
 /**
- * @brief Draw a circle into the buffer.
+ * @brief Draw a fixed-point number into the buffer.
  *
- * @param[in] x0 Circle center X-coordinates (horizontal lines).
+ * Draws value / 10^decimals with exactly decimals digits after the point,
+ * like pcd8544_put_int() otherwise. A reading of 2345 mV drawn with 3
+ * decimals shows as 2.345.
  *
- * @param[in] y0 Circle center Y-coordinates (vertical lines).
+ * @param[in] handle Display handle.
  *
- * @param[in] r Circle radius in pixels.
+ * @param[in] font Font descriptor, see pcd8544_putc_font().
  *
  * @param[in] color Pixel color.
  *
- * @param[in] filled Whether to fill the shape.
+ * @param[in] value Number to draw, in units of 10^-decimals.
+ *
+ * @param[in] decimals Digits after the point, 0 ~ 9.
+ *
+ * @param[in] width Width of the field in characters, point and sign
+ *                  included, 0 for none.
+ *
+ * @param[in] pad Padding character, usually ' ' or '0'.
  *
  * @return
  *      - ESP_OK on success.
- *      - ESP_ERR_INVALID_STATE if:
- *              1. The display has already deinitialized.
- *              2. The display was not initialized yet.
+ *      - ESP_ERR_INVALID_ARG if handle or font is NULL, the font height is
+ *        not 1 ~ PCD8544_FONT_HEIGHT_MAX, or decimals is over 9.
  */
-esp_err_t pcd8544_draw_circle(uint8_t x0, uint8_t y0, uint8_t r,
-                              pcd8544_pixel_color_t color, bool filled);
+esp_err_t pcd8544_put_fixed(pcd8544_handle_t*          handle,
+                            const pcd8544_font_desc_t* font,
+                            pcd8544_pixel_color_t color, int32_t value,
+                            uint8_t decimals, uint8_t width, char pad);
 
 /**
- * @brief Draw a bitmap image into the buffer.
+ * @brief Measure a string of a font descriptor.
  *
- * @note 84 x 48 pixels bitmap image buffer is recommended.
+ * Lines end at '\n', and with a max_width also where
+ * pcd8544_draw_text_box() would wrap them. The width is that of the widest
+ * line, from the left of its first glyph to the right of its last one, so
+ * the spacing after the last glyph and trailing spaces are not counted.
  *
- * @param[in] bitmap The bitmap image buffer.
+ * @param[in] font Font descriptor, see pcd8544_putc_font().
+ *
+ * @param[in] str The UTF-8 string, not a format.
+ *
+ * @param[in] max_width Width lines wrap at, 0 to only break them at '\n'.
+ *
+ * @param[out] width Width of the string in pixels.
+ *
+ * @param[out] height Height of the string in pixels, the number of lines
+ *                    times font->height.
  *
  * @return
  *      - ESP_OK on success.
- *      - ESP_ERR_INVALID_STATE if:
- *              1. The display has already deinitialized.
- *              2. The display was not initialized yet.
+ *      - ESP_ERR_INVALID_ARG if font, str, width or height is NULL, or the
+ *        font height is not 1 ~ PCD8544_FONT_HEIGHT_MAX.
  */
-esp_err_t pcd8544_draw_bitmap(const uint8_t* bitmap);
+esp_err_t pcd8544_text_extent(const pcd8544_font_desc_t* font, const char* str,
+                              uint8_t max_width, uint16_t* width,
+                              uint16_t* height);
 
 /**
- * @brief Scroll the display by creating a new buffer and moving each pixel.
+ * @brief Draw a string of a font descriptor into a box.
  *
- * @param[in] dx The x offset, can be negative to scroll backwards.
+ * The box is cleared to the opposite of color and the string is drawn into
+ * it, aligned and optionally wrapped as the flags say. Nothing is drawn
+ * outside of the box, lines that do not fit are cut off at its edges, and
+ * only the box is flushed. This way a value can be updated in place without
+ * clearing and redrawing the rest of its line. The cursor does not move.
  *
- * @param[in] dy The y offset, can be negative to scroll backwards.
+ * @param[in] handle Display handle.
+ *
+ * @param[in] font Font descriptor, see pcd8544_putc_font().
+ *
+ * @param[in] color Pixel color of the text.
+ *
+ * @param[in] x0 X-coordinate of the first corner of the box.
+ *
+ * @param[in] y0 Y-coordinate of the first corner of the box.
+ *
+ * @param[in] x1 X-coordinate of the opposite corner of the box.
+ *
+ * @param[in] y1 Y-coordinate of the opposite corner of the box.
+ *
+ * @param[in] flags Alignment and wrapping, see pcd8544_text_flags_t.
+ *
+ * @param[in] str The UTF-8 string, not a format.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if handle, font or str is NULL, or the font
+ *        height is not 1 ~ PCD8544_FONT_HEIGHT_MAX.
+ */
+esp_err_t pcd8544_draw_text_box(pcd8544_handle_t*          handle,
+                                const pcd8544_font_desc_t* font,
+                                pcd8544_pixel_color_t color, uint8_t x0,
+                                uint8_t y0, uint8_t x1, uint8_t y1,
+                                uint8_t flags, const char* str);
+
+/**
+ * @brief Create a text console on the display.
+ *
+ * The console spans the full width of the display from config->y down, and
+ * keeps the text of its rows in a ring of lines. Text wraps at the right
+ * edge, and when it goes past the last row the console scrolls up by one
+ * row. Call pcd8544_flush() to update the display.
+ *
+ * @note With the 5x7 font and a y that is a multiple of 8, every row is a
+ * bank of the display: scrolling then moves whole rows of bytes, and in
+ * terminal mode (see pcd8544_set_terminal_mode()) characters go straight to
+ * the display. In terminal mode, a scroll or clear of the console is flushed
+ * right away, before the characters written after it.
+ *
+ * @param[in] handle Display handle.
+ *
+ * @param[in] config Console configuration.
+ *
+ * @param[out] ret_console Pointer of the returned console.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if a parameter is NULL, the font is not one of
+ *        pcd8544_font_t, or the rows do not fit on the display.
+ *      - ESP_ERR_NO_MEM if the console can not be allocated.
+ */
+esp_err_t pcd8544_console_create(pcd8544_handle_t*               handle,
+                                 const pcd8544_console_config_t* config,
+                                 pcd8544_console_t**             ret_console);
+
+/**
+ * @brief Delete a console, its text stays in the buffer.
+ *
+ * @param[in] console Console.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if console is NULL.
+ */
+esp_err_t pcd8544_console_delete(pcd8544_console_t* console);
+
+/**
+ * @brief Write text at the console cursor.
+ *
+ * '\n' starts a new row, '\r' goes back to the start of the row, a tab is
+ * a space and other control characters are ignored.
+ *
+ * @note The cursor of the display (see pcd8544_goto_xy()) is moved.
+ *
+ * @param[in] console Console.
+ *
+ * @param[in] str The text, of any length.
  *
  * @return
  *      - ESP_OK on success.
- *      - ESP_ERR_INVALID_STATE if:
- *              1. The display has already deinitialized.
- *              2. The display was not initialized yet.
+ *      - ESP_ERR_INVALID_ARG if console or str is NULL.
  */
-esp_err_t pcd8544_scroll(int8_t dx, int8_t dy);
+esp_err_t pcd8544_console_write(pcd8544_console_t* console, const char* str);
 
-// /**
-//  * @brief
-//  *
-//  * @param[in] dx
-//  *
-//  * @param[in] dy
-//  *
-//  * @param[in] max_scroll_time_ms
-//  *
-//  * @return
-//  */
-// esp_err_t pcd8544_scroll_smooth(uint8_t dx, uint8_t dy, int
-// max_scroll_time_ms);
+/**
+ * @brief Write formatted text at the console cursor.
+ *
+ * @param[in] console Console.
+ *
+ * @param[in] format Format of the text, see pcd8544_puts_font(). The text
+ * is written as it is formatted, output of any length takes no memory.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if console or format is NULL.
+ */
+esp_err_t pcd8544_console_printf(pcd8544_console_t* console,
+                                 const char* format, ...)
+    __attribute__((format(printf, 2, 3)));
+
+/**
+ * @brief Clear the console and move its cursor to the top.
+ *
+ * @param[in] console Console.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if console is NULL.
+ */
+esp_err_t pcd8544_console_clear(pcd8544_console_t* console);
+
+/**
+ * @brief Draw the console text into the buffer again, e.g. after switching
+ * back from another screen.
+ *
+ * @param[in] console Console.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if console is NULL.
+ */
+esp_err_t pcd8544_console_redraw(pcd8544_console_t* console);
+
+/**
+ * @brief Draw a pixel into the buffer.
+ *
+ * @param[in] handle Display handle.
+ *
+ * @param[in] x X-coordinates (horizontal lines).
+ *
+ * @param[in] y Y-coordinates (vertical lines).
+ *
+ * @param[in] color Pixel color.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if the coordinates is out of display resolution.
+ *      - ESP_ERR_INVALID_ARG if handle is NULL.
+ */
+esp_err_t pcd8544_draw_pixel(pcd8544_handle_t* handle, uint8_t x, uint8_t y,
+                             pcd8544_pixel_color_t color);
+
+/**
+ * @brief Draw a line into the buffer.
+ *
+ * @param[in] handle Display handle.
+ *
+ * @param[in] x0 The start X-coordinates (horizontal lines).
+ *
+ * @param[in] y0 The start Y-coordinates (vertical lines).
+ *
+ * @param[in] x1 The end X-coordinates (horizontal lines).
+ *
+ * @param[in] y1 The end Y-coordinates (vertical lines).
+ *
+ * @param[in] color Pixel color.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if handle is NULL.
+ */
+esp_err_t pcd8544_draw_line(pcd8544_handle_t* handle, uint8_t x0, uint8_t y0,
+                            uint8_t x1, uint8_t y1,
+                            pcd8544_pixel_color_t color);
+
+/**
+ * @brief Draw a rectangle into the buffer.
+ *
+ * @param[in] handle Display handle.
+ *
+ * @param[in] x0 The start X-coordinates (horizontal lines).
+ *
+ * @param[in] y0 The start Y-coordinates (vertical lines).
+ *
+ * @param[in] x1 The end X-coordinates (horizontal lines).
+ *
+ * @param[in] y1 The end Y-coordinates (vertical lines).
+ *
+ * @param[in] color Pixel color.
+ *
+ * @param[in] filled Whether to fill the shape.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if handle is NULL.
+ */
+esp_err_t pcd8544_draw_rectagle(pcd8544_handle_t* handle, uint8_t x0,
+                                uint8_t y0, uint8_t x1, uint8_t y1,
+                                pcd8544_pixel_color_t color, bool filled);
+
+/**
+ * @brief Draw a circle into the buffer.
+ *
+ * @param[in] handle Display handle.
+ *
+ * @param[in] x0 Circle center X-coordinates (horizontal lines).
+ *
+ * @param[in] y0 Circle center Y-coordinates (vertical lines).
+ *
+ * @param[in] r Circle radius in pixels.
+ *
+ * @param[in] color Pixel color.
+ *
+ * @param[in] filled Whether to fill the shape.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if handle is NULL.
+ */
+esp_err_t pcd8544_draw_circle(pcd8544_handle_t* handle, uint8_t x0,
+                              uint8_t y0, uint8_t r,
+                              pcd8544_pixel_color_t color, bool filled);
+
+/**
+ * @brief Draw a bitmap image into the buffer.
+ *
+ * @note 84 x 48 pixels bitmap image buffer is recommended.
+ *
+ * @param[in] handle Display handle.
+ *
+ * @param[in] bitmap The bitmap image buffer.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if handle is NULL.
+ */
+esp_err_t pcd8544_draw_bitmap(pcd8544_handle_t* handle,
+                              const uint8_t*    bitmap);
+
+/**
+ * @brief Draw an image of any size into the buffer.
+ *
+ * The image is in the byte layout of the display: (height + 7) / 8 rows of
+ * width bytes, each byte a column of 8 pixels with bit 0 on top. It can be
+ * placed at any pixel, also partly off the display, and is clipped to it.
+ * Only the area it covers is marked to be flushed.
+ *
+ * @param[in] handle Display handle.
+ *
+ * @param[in] x X-coordinates of the image left edge, can be negative.
+ *
+ * @param[in] y Y-coordinates of the image top edge, can be negative.
+ *
+ * @param[in] width Image width in pixels.
+ *
+ * @param[in] height Image height in pixels.
+ *
+ * @param[in] image The image, set bits are black.
+ *
+ * @param[in] mask Transparency mask in the same layout as the image, only
+ * pixels with a set bit are drawn. NULL draws every pixel of the image.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if handle or image is NULL.
+ */
+esp_err_t pcd8544_blit(pcd8544_handle_t* handle, int16_t x, int16_t y,
+                       uint8_t width, uint8_t height, const uint8_t* image,
+                       const uint8_t* mask);
+
+/**
+ * @brief Draw an image of any size into the buffer in a color.
+ *
+ * Like pcd8544_blit(), which draws with PCD8544_PIXEL_COPY. Black, white and
+ * XOR set, clear or invert the pixels of the set image bits and leave the
+ * others as they are, so an XOR-ed icon or cursor disappears when it is
+ * drawn again. The mask limits every color to the pixels it selects.
+ *
+ * @param[in] handle Display handle.
+ *
+ * @param[in] x X-coordinates of the image left edge, can be negative.
+ *
+ * @param[in] y Y-coordinates of the image top edge, can be negative.
+ *
+ * @param[in] width Image width in pixels.
+ *
+ * @param[in] height Image height in pixels.
+ *
+ * @param[in] image The image, see pcd8544_blit().
+ *
+ * @param[in] mask Transparency mask, see pcd8544_blit(). Can be NULL.
+ *
+ * @param[in] color Pixel color, see pcd8544_pixel_color_t.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if handle or image is NULL.
+ */
+esp_err_t pcd8544_blit_color(pcd8544_handle_t* handle, int16_t x, int16_t y,
+                             uint8_t width, uint8_t height,
+                             const uint8_t* image, const uint8_t* mask,
+                             pcd8544_pixel_color_t color);
+
+/**
+ * @brief Draw a run-length encoded bitmap into the buffer.
+ *
+ * Encoded bitmaps are made by tools/pcd8544_encode.py. A whole frame replaces
+ * the buffer; a delta frame only holds the bytes that differ from the frame
+ * before it and is drawn over that one. Only the bytes that actually change
+ * are marked to be flushed.
+ *
+ * @note On error the bytes decoded so far stay in the buffer.
+ *
+ * @param[in] handle Display handle.
+ *
+ * @param[in] data The encoded bitmap.
+ *
+ * @param[in] len Length of the encoded bitmap in bytes.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if handle or data is NULL, or data is not an
+ *        encoded bitmap.
+ *      - ESP_ERR_INVALID_SIZE if data is truncated or runs past the buffer.
+ */
+esp_err_t pcd8544_draw_rle(pcd8544_handle_t* handle, const uint8_t* data,
+                           size_t len);
+
+/**
+ * @brief Start playing an animation on the display.
+ *
+ * A background task draws the frames with pcd8544_draw_rle() and flushes each
+ * one, so only the bytes that differ from the frame before are sent. While
+ * the render task runs, the frames go out with its next frame instead.
+ *
+ * @note The animation and its frames must stay valid until it is done or
+ * stopped. Drawing into the buffer meanwhile is overwritten where the frames
+ * change it.
+ *
+ * @param[in] handle Display handle.
+ *
+ * @param[in] anim The animation.
+ *
+ * @param[in] loop Whether to start over after the last frame, otherwise the
+ * last frame stays on the display.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if handle is NULL or the animation has no
+ *        frames.
+ *      - ESP_ERR_INVALID_STATE if an animation is already playing.
+ *      - ESP_ERR_NO_MEM if the player task can not be created.
+ */
+esp_err_t pcd8544_anim_play(pcd8544_handle_t* handle,
+                            const pcd8544_anim_t* anim, bool loop);
+
+/**
+ * @brief Pause the animation, the current frame stays on the display.
+ *
+ * @param[in] handle Display handle.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if handle is NULL.
+ *      - ESP_ERR_INVALID_STATE if no animation is playing.
+ */
+esp_err_t pcd8544_anim_pause(pcd8544_handle_t* handle);
+
+/**
+ * @brief Resume a paused animation.
+ *
+ * @note The next frame is shown once the current one has been on the display
+ * for its duration, right away if the pause was longer than that.
+ *
+ * @param[in] handle Display handle.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if handle is NULL.
+ *      - ESP_ERR_INVALID_STATE if no animation is playing.
+ */
+esp_err_t pcd8544_anim_resume(pcd8544_handle_t* handle);
+
+/**
+ * @brief Show a frame of the animation right away and go on from there.
+ *
+ * A paused animation stays paused on the new frame.
+ *
+ * @param[in] handle Display handle.
+ *
+ * @param[in] frame Index of the frame.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if handle is NULL or the frame does not exist.
+ *      - ESP_ERR_INVALID_STATE if no animation is playing.
+ */
+esp_err_t pcd8544_anim_seek(pcd8544_handle_t* handle, size_t frame);
+
+/**
+ * @brief Stop the animation and wait for the player task to end.
+ *
+ * @param[in] handle Display handle.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if handle is NULL.
+ *      - ESP_ERR_INVALID_STATE if no animation is playing.
+ */
+esp_err_t pcd8544_anim_stop(pcd8544_handle_t* handle);
+
+/**
+ * @brief Wait for an animation that does not loop to be done.
+ *
+ * @param[in] handle Display handle.
+ *
+ * @param[in] ticks_to_wait Ticks to wait, portMAX_DELAY to wait forever.
+ *
+ * @return
+ *      - ESP_OK on success, or if no animation is playing.
+ *      - ESP_ERR_INVALID_ARG if handle is NULL.
+ *      - ESP_ERR_TIMEOUT if the animation is not done in time.
+ */
+esp_err_t pcd8544_anim_wait(pcd8544_handle_t* handle,
+                            TickType_t        ticks_to_wait);
+
+/**
+ * @brief Scroll the buffer content inside a rectangular area.
+ *
+ * Pixels shifted out of the area are dropped and the ones shifted in are
+ * white. Everything outside of the area is left as it is, e.g. a fixed header
+ * above a scrolling chart. Call pcd8544_flush() to update the display.
+ *
+ * @note Horizontal shifts move whole bytes, vertical shifts move the bits of
+ * each column, no pixel is drawn one by one.
+ *
+ * @param[in] handle Display handle.
+ *
+ * @param[in] x0 The start X-coordinates of the area.
+ *
+ * @param[in] y0 The start Y-coordinates of the area.
+ *
+ * @param[in] x1 The end X-coordinates of the area.
+ *
+ * @param[in] y1 The end Y-coordinates of the area.
+ *
+ * @param[in] dx The x offset, can be negative to scroll backwards.
+ *
+ * @param[in] dy The y offset, can be negative to scroll backwards.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if handle is NULL.
+ */
+esp_err_t pcd8544_scroll_area(pcd8544_handle_t* handle, uint8_t x0,
+                              uint8_t y0, uint8_t x1, uint8_t y1, int8_t dx,
+                              int8_t dy);
+
+/**
+ * @brief Scroll the whole display and update it.
+ *
+ * @param[in] handle Display handle.
+ *
+ * @param[in] dx The x offset, can be negative to scroll backwards.
+ *
+ * @param[in] dy The y offset, can be negative to scroll backwards.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if handle is NULL.
+ *      - Error of pcd8544_flush() if the update fails.
+ */
+esp_err_t pcd8544_scroll(pcd8544_handle_t* handle, int8_t dx, int8_t dy);
+
+/**
+ * @brief Scroll the whole display smoothly over a period of time.
+ *
+ * The scroll runs in a background task and returns right away. The display is
+ * moved a pixel at a time, or by larger steps when the flushes can not keep
+ * up, and only the changed bytes are sent each step.
+ *
+ * @note Every step is shifted and flushed under the lock of the display, see
+ * pcd8544_begin(). What other tasks draw in the meantime is scrolled along
+ * with the rest by the steps after it; wait for the scroll to be done with
+ * pcd8544_scroll_smooth_wait() to draw at fixed positions.
+ *
+ * @param[in] handle Display handle.
+ *
+ * @param[in] dx The x offset, can be negative to scroll backwards.
+ *
+ * @param[in] dy The y offset, can be negative to scroll backwards.
+ *
+ * @param[in] max_scroll_time_ms The time of the whole scroll in miliseconds.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if handle is NULL or the time is negative.
+ *      - ESP_ERR_INVALID_STATE if a smooth scroll is already running.
+ *      - ESP_ERR_NO_MEM if the scroll task can not be created.
+ */
+esp_err_t pcd8544_scroll_smooth(pcd8544_handle_t* handle, int8_t dx,
+                                int8_t dy, int max_scroll_time_ms);
+
+/**
+ * @brief Wait for a smooth scroll to be done.
+ *
+ * @param[in] handle Display handle.
+ *
+ * @param[in] ticks_to_wait Ticks to wait, portMAX_DELAY to wait forever.
+ *
+ * @return
+ *      - ESP_OK on success, or if no scroll is running.
+ *      - ESP_ERR_INVALID_ARG if handle is NULL.
+ *      - ESP_ERR_TIMEOUT if the scroll is not done in time.
+ */
+esp_err_t pcd8544_scroll_smooth_wait(pcd8544_handle_t* handle,
+                                     TickType_t        ticks_to_wait);
+
+/**
+ * @brief Create an empty display list.
+ *
+ * A display list records drawing calls in a few bytes each, to be drawn into
+ * the buffer of any display later with pcd8544_draw_dlist(). Static parts of
+ * a screen can be recorded once and replayed every frame.
+ *
+ * @param[in] size Bytes available for the recorded calls. A text takes 6
+ * bytes plus its length, the other calls take 4 to 7 bytes, a bitmap takes
+ * 1 byte plus a pointer.
+ *
+ * @param[out] ret_dlist Pointer of the returned display list.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if ret_dlist is NULL.
+ *      - ESP_ERR_NO_MEM if the list can not be allocated.
+ */
+esp_err_t pcd8544_dlist_create(size_t size, pcd8544_dlist_t** ret_dlist);
+
+/**
+ * @brief Delete a display list.
+ *
+ * @param[in] dlist Display list.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if dlist is NULL.
+ */
+esp_err_t pcd8544_dlist_delete(pcd8544_dlist_t* dlist);
+
+/**
+ * @brief Remove all recorded calls from a display list.
+ *
+ * @param[in] dlist Display list.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if dlist is NULL.
+ */
+esp_err_t pcd8544_dlist_reset(pcd8544_dlist_t* dlist);
+
+/**
+ * @brief Record a pixel, see pcd8544_draw_pixel().
+ *
+ * @note Pixels outside of the display are ignored when the list is drawn.
+ *
+ * @param[in] dlist Display list.
+ *
+ * @param[in] x X-coordinates (horizontal lines).
+ *
+ * @param[in] y Y-coordinates (vertical lines).
+ *
+ * @param[in] color Pixel color.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if dlist is NULL.
+ *      - ESP_ERR_NO_MEM if the list is full.
+ */
+esp_err_t pcd8544_dlist_add_pixel(pcd8544_dlist_t* dlist, uint8_t x,
+                                  uint8_t y, pcd8544_pixel_color_t color);
+
+/**
+ * @brief Record a line, see pcd8544_draw_line().
+ *
+ * @param[in] dlist Display list.
+ *
+ * @param[in] x0 The start X-coordinates (horizontal lines).
+ *
+ * @param[in] y0 The start Y-coordinates (vertical lines).
+ *
+ * @param[in] x1 The end X-coordinates (horizontal lines).
+ *
+ * @param[in] y1 The end Y-coordinates (vertical lines).
+ *
+ * @param[in] color Pixel color.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if dlist is NULL.
+ *      - ESP_ERR_NO_MEM if the list is full.
+ */
+esp_err_t pcd8544_dlist_add_line(pcd8544_dlist_t* dlist, uint8_t x0,
+                                 uint8_t y0, uint8_t x1, uint8_t y1,
+                                 pcd8544_pixel_color_t color);
+
+/**
+ * @brief Record a rectangle, see pcd8544_draw_rectagle().
+ *
+ * @param[in] dlist Display list.
+ *
+ * @param[in] x0 The start X-coordinates (horizontal lines).
+ *
+ * @param[in] y0 The start Y-coordinates (vertical lines).
+ *
+ * @param[in] x1 The end X-coordinates (horizontal lines).
+ *
+ * @param[in] y1 The end Y-coordinates (vertical lines).
+ *
+ * @param[in] color Pixel color.
+ *
+ * @param[in] filled Whether to fill the shape.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if dlist is NULL.
+ *      - ESP_ERR_NO_MEM if the list is full.
+ */
+esp_err_t pcd8544_dlist_add_rectangle(pcd8544_dlist_t* dlist, uint8_t x0,
+                                      uint8_t y0, uint8_t x1, uint8_t y1,
+                                      pcd8544_pixel_color_t color,
+                                      bool                  filled);
+
+/**
+ * @brief Record a circle, see pcd8544_draw_circle().
+ *
+ * @param[in] dlist Display list.
+ *
+ * @param[in] x0 Circle center X-coordinates (horizontal lines).
+ *
+ * @param[in] y0 Circle center Y-coordinates (vertical lines).
+ *
+ * @param[in] r Circle radius in pixels.
+ *
+ * @param[in] color Pixel color.
+ *
+ * @param[in] filled Whether to fill the shape.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if dlist is NULL.
+ *      - ESP_ERR_NO_MEM if the list is full.
+ */
+esp_err_t pcd8544_dlist_add_circle(pcd8544_dlist_t* dlist, uint8_t x0,
+                                   uint8_t y0, uint8_t r,
+                                   pcd8544_pixel_color_t color, bool filled);
+
+/**
+ * @brief Record a string drawn from the given position.
+ *
+ * @note The string is copied into the list. The cursor of the display is left
+ * after the last character when the list is drawn, as with pcd8544_puts().
+ *
+ * @param[in] dlist Display list.
+ *
+ * @param[in] x X-coordinates of the first character.
+ *
+ * @param[in] y Y-coordinates of the first character.
+ *
+ * @param[in] font Font size.
+ *
+ * @param[in] color Pixel color.
+ *
+ * @param[in] str The string, UTF-8 like with pcd8544_puts(), at most 255
+ * bytes.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if dlist or str is NULL, or font is not one of
+ *        pcd8544_font_t.
+ *      - ESP_ERR_INVALID_SIZE if the string is too long.
+ *      - ESP_ERR_NO_MEM if the list is full.
+ */
+esp_err_t pcd8544_dlist_add_text(pcd8544_dlist_t* dlist, uint8_t x, uint8_t y,
+                                 pcd8544_font_t        font,
+                                 pcd8544_pixel_color_t color,
+                                 const char*           str);
+
+/**
+ * @brief Record a bitmap image, see pcd8544_draw_bitmap().
+ *
+ * @note Only the pointer is recorded, the bitmap must stay valid as long as
+ * the list is drawn.
+ *
+ * @param[in] dlist Display list.
+ *
+ * @param[in] bitmap The bitmap image buffer.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if dlist or bitmap is NULL.
+ *      - ESP_ERR_NO_MEM if the list is full.
+ */
+esp_err_t pcd8544_dlist_add_bitmap(pcd8544_dlist_t* dlist,
+                                   const uint8_t*   bitmap);
+
+/**
+ * @brief Get the area the recorded calls draw into.
+ *
+ * The area is worked out while recording, so it costs nothing to get. It is
+ * rounded to the 8 pixel rows of the display banks.
+ *
+ * @param[in] dlist Display list.
+ *
+ * @param[out] x0 The start X-coordinates of the area.
+ *
+ * @param[out] y0 The start Y-coordinates of the area.
+ *
+ * @param[out] x1 The end X-coordinates of the area.
+ *
+ * @param[out] y1 The end Y-coordinates of the area.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if a parameter is NULL.
+ *      - ESP_ERR_NOT_FOUND if nothing visible is recorded.
+ */
+esp_err_t pcd8544_dlist_get_area(const pcd8544_dlist_t* dlist, uint8_t* x0,
+                                 uint8_t* y0, uint8_t* x1, uint8_t* y1);
+
+/**
+ * @brief Draw the recorded calls of a display list into the buffer.
+ *
+ * @param[in] handle Display handle.
+ *
+ * @param[in] dlist Display list.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if handle or dlist is NULL.
+ */
+esp_err_t pcd8544_draw_dlist(pcd8544_handle_t*      handle,
+                             const pcd8544_dlist_t* dlist);
+
+/**
+ * @brief Create a screen template.
+ *
+ * A template keeps a whole screen as an image, plus the areas of fields that
+ * are drawn over it by callbacks. Only the fields whose value changed are
+ * restored from the image and drawn again, so a screen with a lot of static
+ * content costs about as much as its changing values.
+ *
+ * @param[in] max_fields Number of fields the template can hold.
+ *
+ * @param[out] ret_tmpl Pointer of the returned template, the image is blank.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if ret_tmpl is NULL.
+ *      - ESP_ERR_NO_MEM if the template can not be allocated.
+ */
+esp_err_t pcd8544_template_create(uint8_t              max_fields,
+                                  pcd8544_template_t** ret_tmpl);
+
+/**
+ * @brief Delete a screen template.
+ *
+ * @param[in] tmpl Template.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if tmpl is NULL.
+ */
+esp_err_t pcd8544_template_delete(pcd8544_template_t* tmpl);
+
+/**
+ * @brief Set the image of a template from an 84 x 48 bitmap.
+ *
+ * @param[in] tmpl Template.
+ *
+ * @param[in] bitmap The bitmap image buffer, copied into the template.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if tmpl or bitmap is NULL.
+ */
+esp_err_t pcd8544_template_set_image(pcd8544_template_t* tmpl,
+                                     const uint8_t*      bitmap);
+
+/**
+ * @brief Set the image of a template by drawing a display list into it.
+ *
+ * @note The list is drawn onto a blank image once, it is not kept.
+ *
+ * @param[in] tmpl Template.
+ *
+ * @param[in] dlist Display list.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if tmpl or dlist is NULL.
+ *      - ESP_ERR_NO_MEM if the drawing canvas can not be allocated.
+ */
+esp_err_t pcd8544_template_render(pcd8544_template_t*    tmpl,
+                                  const pcd8544_dlist_t* dlist);
+
+/**
+ * @brief Set the image of a template from the buffer of a display.
+ *
+ * @param[in] tmpl Template.
+ *
+ * @param[in] handle Display handle.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if tmpl or handle is NULL.
+ */
+esp_err_t pcd8544_template_capture(pcd8544_template_t* tmpl,
+                                   pcd8544_handle_t*   handle);
+
+/**
+ * @brief Add a field to a template.
+ *
+ * @param[in] tmpl Template.
+ *
+ * @param[in] x0 The start X-coordinates of the field.
+ *
+ * @param[in] y0 The start Y-coordinates of the field.
+ *
+ * @param[in] x1 The end X-coordinates of the field.
+ *
+ * @param[in] y1 The end Y-coordinates of the field.
+ *
+ * @param[in] draw_cb Callback drawing the value of the field.
+ *
+ * @param[in] user_ctx User context passed to the callback.
+ *
+ * @param[out] ret_id Id of the field, can be NULL. Ids count up from 0 in
+ * the order the fields are added.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if tmpl or draw_cb is NULL, or the area is off
+ *        the display.
+ *      - ESP_ERR_NO_MEM if the template holds max_fields fields already.
+ */
+esp_err_t pcd8544_template_add_field(pcd8544_template_t* tmpl, uint8_t x0,
+                                     uint8_t y0, uint8_t x1, uint8_t y1,
+                                     pcd8544_field_draw_cb_t draw_cb,
+                                     void* user_ctx, uint8_t* ret_id);
+
+/**
+ * @brief Set the value of a template field.
+ *
+ * The value is copied and compared with the current one. The field is only
+ * drawn again by the next pcd8544_draw_template() if it differs.
+ *
+ * @param[in] tmpl Template.
+ *
+ * @param[in] id Id of the field.
+ *
+ * @param[in] value The value, e.g. a string or a number.
+ *
+ * @param[in] len Length of the value in bytes, at most
+ * PCD8544_FIELD_VALUE_MAX.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if tmpl is NULL, the id is unknown or the value
+ *        is too long.
+ */
+esp_err_t pcd8544_template_set_field(pcd8544_template_t* tmpl, uint8_t id,
+                                     const void* value, size_t len);
+
+/**
+ * @brief Draw a template into the buffer.
+ *
+ * The first time, or after any other drawing into the buffer, the whole image
+ * is copied and every field is drawn. After that only the fields whose value
+ * changed are restored from the image and drawn again, and only their areas
+ * are marked to be flushed.
+ *
+ * @note Field values are kept in the template, so a template shown on several
+ * displays at once should have one copy each.
+ *
+ * @param[in] handle Display handle.
+ *
+ * @param[in] tmpl Template.
+ *
+ * @return
+ *      - ESP_OK on success.
+ *      - ESP_ERR_INVALID_ARG if handle or tmpl is NULL.
+ */
+esp_err_t pcd8544_draw_template(pcd8544_handle_t*   handle,
+                                pcd8544_template_t* tmpl);
 
 #ifdef __cplusplus
 }
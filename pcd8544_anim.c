@@ -0,0 +1,174 @@
+#include <stdint.h>
+
+#include "pcd8544.h"
+#include "pcd8544_priv.h"
+
+// Animation player task
+#define PCD8544_ANIM_TASK_STACK 2048
+#define PCD8544_ANIM_TASK_PRIO  5
+
+// Bring the buffer to a frame. A delta frame only applies on top of the one
+// before it, so anything other than the next frame is rebuilt from the whole
+// first frame on; only the bytes that end up different are flushed anyway.
+static void pcd8544_anim_show(pcd8544_handle_t* handle, size_t frame) {
+    const pcd8544_anim_t* anim  = handle->anim;
+    size_t                first = frame;
+
+    if (anim->delta && frame != handle->anim_shown + 1) first = 0;
+
+    for (size_t i = first; i <= frame; i++)
+        pcd8544_draw_rle(handle, anim->frames[i].data, anim->frames[i].len);
+
+    handle->anim_shown = frame;
+}
+
+// Player task of pcd8544_anim_play(). It sleeps until the current frame is
+// due to end, or until a control call wakes it up, all state changes are made
+// by the control calls under the lock.
+static void pcd8544_anim_task(void* arg) {
+    pcd8544_handle_t* handle   = arg;
+    TickType_t        deadline = xTaskGetTickCount();
+    TickType_t        wait;
+
+    for (;;) {
+        xSemaphoreTakeRecursive(handle->lock, portMAX_DELAY);
+
+        TickType_t now  = xTaskGetTickCount();
+        bool       show = handle->anim_seek ||
+                    (!handle->anim_paused && (int32_t)(now - deadline) >= 0);
+
+        // Past the last frame the player starts over or is done
+        if (show && handle->anim_next == handle->anim->frame_num) {
+            if (handle->anim_loop)
+                handle->anim_next = 0;
+            else
+                handle->anim_stop = true;
+        }
+        if (handle->anim_stop) break;
+
+        if (show) {
+            const pcd8544_anim_frame_t* frame =
+                &handle->anim->frames[handle->anim_next];
+
+            pcd8544_anim_show(handle, handle->anim_next++);
+
+            deadline          = now + pdMS_TO_TICKS(frame->duration_ms);
+            handle->anim_seek = false;
+        }
+
+        wait = handle->anim_paused ? portMAX_DELAY : deadline - now;
+        xSemaphoreGiveRecursive(handle->lock);
+
+        // Flushed without the lock like the render task does, drawing and the
+        // control calls go on meanwhile
+        if (show) pcd8544_flush(handle);
+
+        ulTaskNotifyTake(pdTRUE, wait);
+    }
+
+    handle->anim_task = NULL;
+    xSemaphoreGiveRecursive(handle->lock);
+
+    xSemaphoreGive(handle->anim_idle);
+    vTaskDelete(NULL);
+}
+
+esp_err_t pcd8544_anim_play(pcd8544_handle_t* handle,
+                            const pcd8544_anim_t* anim, bool loop) {
+    if (!handle || !anim || !anim->frames || !anim->frame_num)
+        return ESP_ERR_INVALID_ARG;
+
+    if (!handle->anim_idle) {
+        handle->anim_idle = xSemaphoreCreateBinary();
+        if (!handle->anim_idle) return ESP_ERR_NO_MEM;
+        xSemaphoreGive(handle->anim_idle);
+    }
+
+    if (xSemaphoreTake(handle->anim_idle, 0) != pdTRUE)
+        return ESP_ERR_INVALID_STATE;
+
+    handle->anim        = anim;
+    handle->anim_next   = 0;
+    handle->anim_shown  = SIZE_MAX;
+    handle->anim_loop   = loop;
+    handle->anim_paused = false;
+    handle->anim_seek   = false;
+    handle->anim_stop   = false;
+
+    if (xTaskCreate(pcd8544_anim_task, "pcd8544_anim",
+                    PCD8544_ANIM_TASK_STACK, handle, PCD8544_ANIM_TASK_PRIO,
+                    &handle->anim_task) != pdPASS) {
+        handle->anim_task = NULL;
+        xSemaphoreGive(handle->anim_idle);
+        return ESP_ERR_NO_MEM;
+    }
+
+    return ESP_OK;
+}
+
+// Change the player state under the lock and wake the player task up to act
+// on it
+static esp_err_t pcd8544_anim_control(pcd8544_handle_t* handle, bool paused,
+                                      bool stop, size_t seek) {
+    if (!handle) return ESP_ERR_INVALID_ARG;
+
+    xSemaphoreTakeRecursive(handle->lock, portMAX_DELAY);
+    if (!handle->anim_task) {
+        xSemaphoreGiveRecursive(handle->lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (seek != SIZE_MAX && seek >= handle->anim->frame_num) {
+        xSemaphoreGiveRecursive(handle->lock);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    handle->anim_paused = paused;
+    handle->anim_stop   = stop;
+    if (seek != SIZE_MAX) {
+        handle->anim_next = seek;
+        handle->anim_seek = true;
+    }
+    xTaskNotifyGive(handle->anim_task);
+    xSemaphoreGiveRecursive(handle->lock);
+
+    return ESP_OK;
+}
+
+esp_err_t pcd8544_anim_pause(pcd8544_handle_t* handle) {
+    return pcd8544_anim_control(handle, true, false, SIZE_MAX);
+}
+
+esp_err_t pcd8544_anim_resume(pcd8544_handle_t* handle) {
+    return pcd8544_anim_control(handle, false, false, SIZE_MAX);
+}
+
+esp_err_t pcd8544_anim_seek(pcd8544_handle_t* handle, size_t frame) {
+    if (!handle) return ESP_ERR_INVALID_ARG;
+
+    // Seeking keeps the player paused or running as it is
+    xSemaphoreTakeRecursive(handle->lock, portMAX_DELAY);
+    esp_err_t ret =
+        pcd8544_anim_control(handle, handle->anim_paused, false, frame);
+    xSemaphoreGiveRecursive(handle->lock);
+
+    return ret;
+}
+
+esp_err_t pcd8544_anim_stop(pcd8544_handle_t* handle) {
+    esp_err_t ret = pcd8544_anim_control(handle, false, true, SIZE_MAX);
+    if (ret != ESP_OK) return ret;
+
+    return pcd8544_anim_wait(handle, portMAX_DELAY);
+}
+
+esp_err_t pcd8544_anim_wait(pcd8544_handle_t* handle,
+                            TickType_t        ticks_to_wait) {
+    if (!handle) return ESP_ERR_INVALID_ARG;
+    if (!handle->anim_idle) return ESP_OK;
+
+    if (xSemaphoreTake(handle->anim_idle, ticks_to_wait) != pdTRUE)
+        return ESP_ERR_TIMEOUT;
+
+    xSemaphoreGive(handle->anim_idle);
+    return ESP_OK;
+}
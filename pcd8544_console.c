@@ -0,0 +1,193 @@
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pcd8544.h"
+#include "pcd8544_priv.h"
+
+struct pcd8544_console_t {
+    pcd8544_handle_t* handle;
+    pcd8544_font_t    font;
+    uint8_t           y;  // Top of the console on the display
+    uint8_t           rows;
+    uint8_t           cols;
+    uint8_t           c_width;
+    uint8_t           c_height;
+    uint8_t           row;  // Cursor, row 0 is the top of the console
+    uint8_t           col;
+    uint8_t           top;  // Line of the text ring shown on row 0
+    // Ring of rows lines of cols characters, 0 where nothing is written
+    char text[];
+};
+
+static char* pcd8544_console_line(pcd8544_console_t* console, uint8_t row) {
+    return &console->text[((console->top + row) % console->rows) *
+                          console->cols];
+}
+
+// Characters are copied into their cell, replacing what a reused cell held
+static void pcd8544_console_draw_char(pcd8544_console_t* console,
+                                      uint8_t row, uint8_t col, char c) {
+    console->handle->_x = col * console->c_width;
+    console->handle->_y = console->y + row * console->c_height;
+    pcd8544_draw_char(console->handle, console->font, PCD8544_PIXEL_COPY, c);
+}
+
+// In terminal mode the characters drawn next go straight to the display, so
+// the pixels the console moved or cleared in the buffer are sent first, or
+// the new characters would show on top of the old rows until the next flush.
+// A failed flush is sent again with the next one.
+static void pcd8544_console_sync(pcd8544_console_t* console) {
+    if (console->handle->terminal_mode) pcd8544_flush(console->handle);
+}
+
+// Move the cursor to the start of the next row. Past the last row, the
+// console moves up by one row: the oldest line of the ring is reused for the
+// new one, and the pixels move with pcd8544_shift_area(), which is a memmove
+// of whole banks when the rows are bank-aligned.
+static void pcd8544_console_newline(pcd8544_console_t* console) {
+    console->col = 0;
+
+    if (console->row + 1 < console->rows) {
+        console->row++;
+        return;
+    }
+
+    memset(pcd8544_console_line(console, 0), 0, console->cols);
+    console->top = (console->top + 1) % console->rows;
+
+    pcd8544_shift_area(console->handle, 0, console->y, PCD8544_H_RES_MAX - 1,
+                       console->y + console->rows * console->c_height - 1, 0,
+                       -console->c_height);
+    pcd8544_console_sync(console);
+}
+
+static void pcd8544_console_putc(pcd8544_console_t* console, char c) {
+    if (c == '\n') {
+        pcd8544_console_newline(console);
+        return;
+    }
+    if (c == '\r') {
+        console->col = 0;
+        return;
+    }
+    if (c == '\t') c = ' ';
+    if (c < ' ' || c > '~') return;
+
+    // Wrap only when there is something to put on the next row, so a line
+    // that fills the row exactly does not leave an empty one behind
+    if (console->col == console->cols) pcd8544_console_newline(console);
+
+    char* line = pcd8544_console_line(console, console->row);
+
+    line[console->col] = c;
+    pcd8544_console_draw_char(console, console->row, console->col, c);
+    console->col++;
+}
+
+esp_err_t pcd8544_console_create(pcd8544_handle_t*               handle,
+                                 const pcd8544_console_config_t* config,
+                                 pcd8544_console_t**             ret_console) {
+    if (!handle || !config || !ret_console ||
+        !pcd8544_font_exists(config->font))
+        return ESP_ERR_INVALID_ARG;
+
+    uint8_t c_width, c_height;
+    pcd8544_font_cell(config->font, &c_width, &c_height);
+
+    if (config->y >= PCD8544_V_RES_MAX) return ESP_ERR_INVALID_ARG;
+
+    uint8_t fit  = (PCD8544_V_RES_MAX - config->y) / c_height;
+    uint8_t rows = config->rows ? config->rows : fit;
+    uint8_t cols = PCD8544_H_RES_MAX / c_width;
+
+    if (!rows || rows > fit) return ESP_ERR_INVALID_ARG;
+
+    pcd8544_console_t* console =
+        calloc(1, sizeof(pcd8544_console_t) + rows * cols);
+    if (!console) return ESP_ERR_NO_MEM;
+
+    console->handle   = handle;
+    console->font     = config->font;
+    console->y        = config->y;
+    console->rows     = rows;
+    console->cols     = cols;
+    console->c_width  = c_width;
+    console->c_height = c_height;
+
+    *ret_console = console;
+    return ESP_OK;
+}
+
+esp_err_t pcd8544_console_delete(pcd8544_console_t* console) {
+    if (!console) return ESP_ERR_INVALID_ARG;
+    free(console);
+    return ESP_OK;
+}
+
+esp_err_t pcd8544_console_write(pcd8544_console_t* console, const char* str) {
+    if (!console || !str) return ESP_ERR_INVALID_ARG;
+
+    PCD8544_LOCK(console->handle);
+    while (*str) pcd8544_console_putc(console, *str++);
+    PCD8544_UNLOCK(console->handle);
+
+    return ESP_OK;
+}
+
+static void pcd8544_console_emit(void* ctx, const char* str, size_t len) {
+    while (len--) pcd8544_console_putc(ctx, *str++);
+}
+
+esp_err_t pcd8544_console_printf(pcd8544_console_t* console,
+                                 const char* format, ...) {
+    if (!console || !format) return ESP_ERR_INVALID_ARG;
+
+    // Output goes to the console as it is formatted, of any length
+    va_list arg;
+
+    va_start(arg, format);
+    PCD8544_LOCK(console->handle);
+    pcd8544_format(pcd8544_console_emit, console, format, arg);
+    PCD8544_UNLOCK(console->handle);
+    va_end(arg);
+
+    return ESP_OK;
+}
+
+esp_err_t pcd8544_console_clear(pcd8544_console_t* console) {
+    if (!console) return ESP_ERR_INVALID_ARG;
+
+    PCD8544_LOCK(console->handle);
+    memset(console->text, 0, console->rows * console->cols);
+    console->row = 0;
+    console->col = 0;
+    console->top = 0;
+    pcd8544_fill_area(console->handle, 0, console->y, PCD8544_H_RES_MAX - 1,
+                      console->y + console->rows * console->c_height - 1,
+                      PCD8544_PIXEL_WHITE);
+    pcd8544_console_sync(console);
+    PCD8544_UNLOCK(console->handle);
+
+    return ESP_OK;
+}
+
+esp_err_t pcd8544_console_redraw(pcd8544_console_t* console) {
+    if (!console) return ESP_ERR_INVALID_ARG;
+
+    PCD8544_LOCK(console->handle);
+    pcd8544_fill_area(console->handle, 0, console->y, PCD8544_H_RES_MAX - 1,
+                      console->y + console->rows * console->c_height - 1,
+                      PCD8544_PIXEL_WHITE);
+
+    for (uint8_t row = 0; row < console->rows; row++) {
+        const char* line = pcd8544_console_line(console, row);
+
+        for (uint8_t col = 0; col < console->cols; col++)
+            if (line[col])
+                pcd8544_console_draw_char(console, row, col, line[col]);
+    }
+    PCD8544_UNLOCK(console->handle);
+
+    return ESP_OK;
+}
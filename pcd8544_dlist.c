@@ -0,0 +1,310 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "pcd8544.h"
+#include "pcd8544_priv.h"
+#include "sys/param.h"
+
+// Every entry is an opcode byte followed by its arguments, one byte each
+// unless noted otherwise
+typedef enum {
+    PCD8544_DL_PIXEL,   // x, y, color
+    PCD8544_DL_LINE,    // x0, y0, x1, y1, color
+    PCD8544_DL_RECT,    // x0, y0, x1, y1, color, filled
+    PCD8544_DL_CIRCLE,  // x0, y0, r, color, filled
+    PCD8544_DL_TEXT,    // x, y, font, color, length, characters
+    PCD8544_DL_BITMAP,  // pointer to the bitmap
+} pcd8544_dl_op_t;
+
+struct pcd8544_dlist_t {
+    // Area the entries draw into, kept per bank like the dirty area of a
+    // display
+    uint8_t area_xmin[PCD8544_BANK_NUM];
+    uint8_t area_xmax[PCD8544_BANK_NUM];
+    size_t  size;
+    size_t  len;
+    uint8_t ops[];
+};
+
+static void pcd8544_dlist_add_area(pcd8544_dlist_t* dlist, int16_t x0,
+                                   int16_t y0, int16_t x1, int16_t y1) {
+    if (x1 < 0 || y1 < 0 || x0 >= PCD8544_H_RES_MAX ||
+        y0 >= PCD8544_V_RES_MAX)
+        return;
+
+    x0 = MAX(x0, 0);
+    y0 = MAX(y0, 0);
+    x1 = MIN(x1, PCD8544_H_RES_MAX - 1);
+    y1 = MIN(y1, PCD8544_V_RES_MAX - 1);
+
+    for (uint8_t i = y0 / 8; i <= y1 / 8; i++) {
+        dlist->area_xmin[i] = MIN(x0, dlist->area_xmin[i]);
+        dlist->area_xmax[i] = MAX(x1, dlist->area_xmax[i]);
+    }
+}
+
+// Reserve room for an entry, NULL when the list is full
+static uint8_t* pcd8544_dlist_alloc(pcd8544_dlist_t* dlist, size_t len) {
+    if (dlist->len + len > dlist->size) return NULL;
+
+    uint8_t* entry = &dlist->ops[dlist->len];
+    dlist->len += len;
+    return entry;
+}
+
+esp_err_t pcd8544_dlist_create(size_t size, pcd8544_dlist_t** ret_dlist) {
+    if (!ret_dlist) return ESP_ERR_INVALID_ARG;
+
+    pcd8544_dlist_t* dlist = calloc(1, sizeof(pcd8544_dlist_t) + size);
+    if (!dlist) return ESP_ERR_NO_MEM;
+
+    dlist->size = size;
+    pcd8544_dlist_reset(dlist);
+
+    *ret_dlist = dlist;
+    return ESP_OK;
+}
+
+esp_err_t pcd8544_dlist_delete(pcd8544_dlist_t* dlist) {
+    if (!dlist) return ESP_ERR_INVALID_ARG;
+    free(dlist);
+    return ESP_OK;
+}
+
+esp_err_t pcd8544_dlist_reset(pcd8544_dlist_t* dlist) {
+    if (!dlist) return ESP_ERR_INVALID_ARG;
+
+    dlist->len = 0;
+    memset(dlist->area_xmin, PCD8544_H_RES_MAX - 1, sizeof(dlist->area_xmin));
+    memset(dlist->area_xmax, 0, sizeof(dlist->area_xmax));
+    return ESP_OK;
+}
+
+esp_err_t pcd8544_dlist_add_pixel(pcd8544_dlist_t* dlist, uint8_t x,
+                                  uint8_t y, pcd8544_pixel_color_t color) {
+    if (!dlist) return ESP_ERR_INVALID_ARG;
+
+    uint8_t* entry = pcd8544_dlist_alloc(dlist, 4);
+    if (!entry) return ESP_ERR_NO_MEM;
+
+    entry[0] = PCD8544_DL_PIXEL;
+    entry[1] = x;
+    entry[2] = y;
+    entry[3] = color;
+
+    pcd8544_dlist_add_area(dlist, x, y, x, y);
+    return ESP_OK;
+}
+
+esp_err_t pcd8544_dlist_add_line(pcd8544_dlist_t* dlist, uint8_t x0,
+                                 uint8_t y0, uint8_t x1, uint8_t y1,
+                                 pcd8544_pixel_color_t color) {
+    if (!dlist) return ESP_ERR_INVALID_ARG;
+
+    uint8_t* entry = pcd8544_dlist_alloc(dlist, 6);
+    if (!entry) return ESP_ERR_NO_MEM;
+
+    entry[0] = PCD8544_DL_LINE;
+    entry[1] = x0;
+    entry[2] = y0;
+    entry[3] = x1;
+    entry[4] = y1;
+    entry[5] = color;
+
+    pcd8544_dlist_add_area(dlist, MIN(x0, x1), MIN(y0, y1), MAX(x0, x1),
+                           MAX(y0, y1));
+    return ESP_OK;
+}
+
+esp_err_t pcd8544_dlist_add_rectangle(pcd8544_dlist_t* dlist, uint8_t x0,
+                                      uint8_t y0, uint8_t x1, uint8_t y1,
+                                      pcd8544_pixel_color_t color,
+                                      bool                  filled) {
+    if (!dlist) return ESP_ERR_INVALID_ARG;
+
+    uint8_t* entry = pcd8544_dlist_alloc(dlist, 7);
+    if (!entry) return ESP_ERR_NO_MEM;
+
+    entry[0] = PCD8544_DL_RECT;
+    entry[1] = x0;
+    entry[2] = y0;
+    entry[3] = x1;
+    entry[4] = y1;
+    entry[5] = color;
+    entry[6] = filled;
+
+    pcd8544_dlist_add_area(dlist, MIN(x0, x1), MIN(y0, y1), MAX(x0, x1),
+                           MAX(y0, y1));
+    return ESP_OK;
+}
+
+esp_err_t pcd8544_dlist_add_circle(pcd8544_dlist_t* dlist, uint8_t x0,
+                                   uint8_t y0, uint8_t r,
+                                   pcd8544_pixel_color_t color, bool filled) {
+    if (!dlist) return ESP_ERR_INVALID_ARG;
+
+    uint8_t* entry = pcd8544_dlist_alloc(dlist, 6);
+    if (!entry) return ESP_ERR_NO_MEM;
+
+    entry[0] = PCD8544_DL_CIRCLE;
+    entry[1] = x0;
+    entry[2] = y0;
+    entry[3] = r;
+    entry[4] = color;
+    entry[5] = filled;
+
+    pcd8544_dlist_add_area(dlist, x0 - r, y0 - r, x0 + r, y0 + r);
+    return ESP_OK;
+}
+
+esp_err_t pcd8544_dlist_add_text(pcd8544_dlist_t* dlist, uint8_t x, uint8_t y,
+                                 pcd8544_font_t        font,
+                                 pcd8544_pixel_color_t color,
+                                 const char*           str) {
+    if (!dlist || !pcd8544_font_exists(font) || !str)
+        return ESP_ERR_INVALID_ARG;
+
+    size_t len = strlen(str);
+    if (len > UINT8_MAX) return ESP_ERR_INVALID_SIZE;
+
+    uint8_t* entry = pcd8544_dlist_alloc(dlist, 6 + len);
+    if (!entry) return ESP_ERR_NO_MEM;
+
+    entry[0] = PCD8544_DL_TEXT;
+    entry[1] = x;
+    entry[2] = y;
+    entry[3] = font;
+    entry[4] = color;
+    entry[5] = len;
+    memcpy(&entry[6], str, len);
+
+    // Follow the cursor the same way drawing the characters will, see
+    // pcd8544_draw_glyph(). A copy draws the whole cell, spacing included.
+    const pcd8544_font_desc_t* desc = pcd8544_font_desc(font);
+    const char*                end  = str + len;
+    pcd8544_glyph_t            glyph;
+
+    while (str < end) {
+        if (!pcd8544_font_glyph(desc, pcd8544_utf8_next(&str, end), &glyph))
+            continue;
+
+        uint8_t cols =
+            color == PCD8544_PIXEL_COPY ? glyph.advance : glyph.width;
+
+        if (x + glyph.advance > PCD8544_H_RES_MAX) {
+            y = MIN(y + desc->height, PCD8544_V_RES_MAX);
+            x = 0;
+        }
+        if (cols)
+            pcd8544_dlist_add_area(dlist, x, y, x + cols - 1,
+                                   y + desc->height - 1);
+        x += glyph.advance;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t pcd8544_dlist_add_bitmap(pcd8544_dlist_t* dlist,
+                                   const uint8_t*   bitmap) {
+    if (!dlist || !bitmap) return ESP_ERR_INVALID_ARG;
+
+    uint8_t* entry = pcd8544_dlist_alloc(dlist, 1 + sizeof(bitmap));
+    if (!entry) return ESP_ERR_NO_MEM;
+
+    // The bitmap is not copied, only referenced
+    entry[0] = PCD8544_DL_BITMAP;
+    memcpy(&entry[1], &bitmap, sizeof(bitmap));
+
+    pcd8544_dlist_add_area(dlist, 0, 0, PCD8544_H_RES_MAX - 1,
+                           PCD8544_V_RES_MAX - 1);
+    return ESP_OK;
+}
+
+esp_err_t pcd8544_dlist_get_area(const pcd8544_dlist_t* dlist, uint8_t* x0,
+                                 uint8_t* y0, uint8_t* x1, uint8_t* y1) {
+    if (!dlist || !x0 || !y0 || !x1 || !y1) return ESP_ERR_INVALID_ARG;
+
+    bool found = false;
+
+    *x0 = PCD8544_H_RES_MAX - 1;
+    *x1 = 0;
+    for (uint8_t i = 0; i < PCD8544_BANK_NUM; i++) {
+        if (dlist->area_xmin[i] > dlist->area_xmax[i]) continue;
+
+        if (!found) *y0 = i * 8;
+        *y1   = i * 8 + 7;
+        *x0   = MIN(*x0, dlist->area_xmin[i]);
+        *x1   = MAX(*x1, dlist->area_xmax[i]);
+        found = true;
+    }
+
+    return found ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+void pcd8544_dlist_replay(pcd8544_handle_t*      handle,
+                          const pcd8544_dlist_t* dlist) {
+    const uint8_t* op  = dlist->ops;
+    const uint8_t* end = dlist->ops + dlist->len;
+
+    while (op < end) {
+        switch (op[0]) {
+            case PCD8544_DL_PIXEL:
+                pcd8544_plot(handle, op[1], op[2], op[3]);
+                op += 4;
+                break;
+
+            case PCD8544_DL_LINE:
+                pcd8544_line(handle, op[1], op[2], op[3], op[4], op[5]);
+                op += 6;
+                break;
+
+            case PCD8544_DL_RECT:
+                pcd8544_rectangle(handle, op[1], op[2], op[3], op[4], op[5],
+                                  op[6]);
+                op += 7;
+                break;
+
+            case PCD8544_DL_CIRCLE:
+                pcd8544_circle(handle, op[1], op[2], op[3], op[4], op[5]);
+                op += 6;
+                break;
+
+            case PCD8544_DL_TEXT:
+                // UTF-8 like pcd8544_puts()
+                handle->_x = op[1];
+                handle->_y = op[2];
+                pcd8544_draw_utf8(handle, pcd8544_font_desc(op[3]), op[4],
+                                  (const char*)&op[6], op[5]);
+                op += 6 + op[5];
+                break;
+
+            case PCD8544_DL_BITMAP: {
+                const uint8_t* bitmap;
+
+                memcpy(&bitmap, &op[1], sizeof(bitmap));
+                memcpy(handle->buffer, bitmap, PCD8544_BUFFER_SIZE);
+                pcd8544_update_area(handle, 0, 0, PCD8544_H_RES_MAX - 1,
+                                    PCD8544_V_RES_MAX - 1);
+                op += 1 + sizeof(bitmap);
+                break;
+            }
+
+            default:
+                // Can not happen, entries are only written by this file
+                op = end;
+                break;
+        }
+    }
+}
+
+esp_err_t pcd8544_draw_dlist(pcd8544_handle_t*      handle,
+                             const pcd8544_dlist_t* dlist) {
+    if (!handle || !dlist) return ESP_ERR_INVALID_ARG;
+
+    // The whole list is drawn under one lock
+    PCD8544_LOCK(handle);
+    pcd8544_dlist_replay(handle, dlist);
+    PCD8544_UNLOCK(handle);
+
+    return ESP_OK;
+}
@@ -203,4 +203,314 @@ DRAM_ATTR static const uint8_t pcd8544_3x5_charset[][3] = {
     {0x04, 0x06, 0x02},  // ~
 };
 
+// Packed fonts, generated by tools/pcd8544_font.py. They stay in flash, only
+// the glyphs drawn are read.
+
+// pcd8544_font.py --trim --space 3 -n pcd8544_5x7_prop tools/fonts/5x7.txt
+static const uint8_t pcd8544_5x7_prop_bitmap[563] = {
+    0x5F, 0x07, 0x00, 0x07, 0x14, 0x7F, 0x14, 0x7F, 0x14, 0x24, 0x2A, 0x7F,
+    0x2A, 0x12, 0x23, 0x13, 0x08, 0x64, 0x62, 0x36, 0x49, 0x55, 0x22, 0x50,
+    0x05, 0x03, 0x1C, 0x22, 0x41, 0x41, 0x22, 0x1C, 0x14, 0x08, 0x3E, 0x08,
+    0x14, 0x08, 0x08, 0x3E, 0x08, 0x08, 0x50, 0x30, 0x08, 0x08, 0x08, 0x08,
+    0x08, 0x60, 0x60, 0x20, 0x10, 0x08, 0x04, 0x02, 0x3E, 0x51, 0x49, 0x45,
+    0x3E, 0x42, 0x7F, 0x40, 0x42, 0x61, 0x51, 0x49, 0x46, 0x21, 0x41, 0x45,
+    0x4B, 0x31, 0x18, 0x14, 0x12, 0x7F, 0x10, 0x27, 0x45, 0x45, 0x45, 0x39,
+    0x3C, 0x4A, 0x49, 0x49, 0x30, 0x01, 0x71, 0x09, 0x05, 0x03, 0x36, 0x49,
+    0x49, 0x49, 0x36, 0x06, 0x49, 0x49, 0x29, 0x1E, 0x36, 0x36, 0x56, 0x36,
+    0x10, 0x28, 0x44, 0x14, 0x14, 0x14, 0x14, 0x14, 0x44, 0x28, 0x10, 0x02,
+    0x01, 0x51, 0x09, 0x06, 0x32, 0x49, 0x79, 0x41, 0x3E, 0x7E, 0x11, 0x11,
+    0x11, 0x7E, 0x7F, 0x49, 0x49, 0x49, 0x36, 0x3E, 0x41, 0x41, 0x41, 0x22,
+    0x7F, 0x41, 0x41, 0x22, 0x1C, 0x7F, 0x49, 0x49, 0x49, 0x41, 0x7F, 0x09,
+    0x09, 0x09, 0x01, 0x3E, 0x41, 0x49, 0x49, 0x7A, 0x7F, 0x08, 0x08, 0x08,
+    0x7F, 0x41, 0x7F, 0x41, 0x20, 0x40, 0x41, 0x3F, 0x01, 0x7F, 0x08, 0x14,
+    0x22, 0x41, 0x7F, 0x40, 0x40, 0x40, 0x40, 0x7F, 0x02, 0x0C, 0x02, 0x7F,
+    0x7F, 0x04, 0x08, 0x10, 0x7F, 0x3E, 0x41, 0x41, 0x41, 0x3E, 0x7F, 0x09,
+    0x09, 0x09, 0x06, 0x3E, 0x41, 0x51, 0x21, 0x5E, 0x7F, 0x09, 0x19, 0x29,
+    0x46, 0x46, 0x49, 0x49, 0x49, 0x31, 0x01, 0x01, 0x7F, 0x01, 0x01, 0x3F,
+    0x40, 0x40, 0x40, 0x3F, 0x1F, 0x20, 0x40, 0x20, 0x1F, 0x3F, 0x40, 0x38,
+    0x40, 0x3F, 0x63, 0x14, 0x08, 0x14, 0x63, 0x07, 0x08, 0x70, 0x08, 0x07,
+    0x61, 0x51, 0x49, 0x45, 0x43, 0x7F, 0x41, 0x41, 0x02, 0x04, 0x08, 0x10,
+    0x20, 0x41, 0x41, 0x7F, 0x04, 0x02, 0x01, 0x02, 0x04, 0x40, 0x40, 0x40,
+    0x40, 0x40, 0x01, 0x02, 0x04, 0x20, 0x54, 0x54, 0x54, 0x78, 0x7F, 0x48,
+    0x44, 0x44, 0x38, 0x38, 0x44, 0x44, 0x44, 0x20, 0x38, 0x44, 0x44, 0x48,
+    0x7F, 0x38, 0x54, 0x54, 0x54, 0x18, 0x08, 0x7E, 0x09, 0x01, 0x02, 0x0C,
+    0x52, 0x52, 0x52, 0x3E, 0x7F, 0x08, 0x04, 0x04, 0x78, 0x44, 0x7D, 0x40,
+    0x20, 0x40, 0x44, 0x3D, 0x7F, 0x10, 0x28, 0x44, 0x41, 0x7F, 0x40, 0x7C,
+    0x04, 0x18, 0x04, 0x78, 0x7C, 0x08, 0x04, 0x04, 0x78, 0x38, 0x44, 0x44,
+    0x44, 0x38, 0x7C, 0x14, 0x14, 0x14, 0x08, 0x08, 0x14, 0x14, 0x18, 0x7C,
+    0x7C, 0x08, 0x04, 0x04, 0x08, 0x48, 0x54, 0x54, 0x54, 0x20, 0x04, 0x3F,
+    0x44, 0x40, 0x20, 0x3C, 0x40, 0x40, 0x20, 0x7C, 0x1C, 0x20, 0x40, 0x20,
+    0x1C, 0x3C, 0x40, 0x30, 0x40, 0x3C, 0x44, 0x28, 0x10, 0x28, 0x44, 0x0C,
+    0x50, 0x50, 0x50, 0x3C, 0x44, 0x64, 0x54, 0x4C, 0x44, 0x08, 0x36, 0x41,
+    0x7F, 0x41, 0x36, 0x08, 0x10, 0x08, 0x08, 0x10, 0x08, 0x7D, 0x02, 0x05,
+    0x02, 0x30, 0x48, 0x45, 0x40, 0x20, 0x7C, 0x13, 0x12, 0x13, 0x7C, 0x3E,
+    0x41, 0xC1, 0x41, 0x22, 0x7E, 0x42, 0x42, 0x43, 0x42, 0x7E, 0x09, 0x01,
+    0x10, 0x7F, 0x3C, 0x43, 0x42, 0x43, 0x3C, 0x3E, 0x41, 0x40, 0x41, 0x3E,
+    0x7E, 0x01, 0x49, 0x56, 0x20, 0x20, 0x55, 0x56, 0x54, 0x78, 0x20, 0x54,
+    0x56, 0x55, 0x78, 0x20, 0x56, 0x55, 0x56, 0x78, 0x20, 0x55, 0x54, 0x55,
+    0x78, 0x38, 0x44, 0xC4, 0x44, 0x20, 0x38, 0x55, 0x56, 0x54, 0x18, 0x38,
+    0x54, 0x56, 0x55, 0x18, 0x38, 0x56, 0x55, 0x56, 0x18, 0x38, 0x55, 0x54,
+    0x55, 0x18, 0x45, 0x7E, 0x40, 0x44, 0x7E, 0x41, 0x46, 0x7D, 0x42, 0x45,
+    0x7C, 0x41, 0x7E, 0x09, 0x05, 0x06, 0x79, 0x38, 0x45, 0x46, 0x44, 0x38,
+    0x38, 0x44, 0x46, 0x45, 0x38, 0x38, 0x46, 0x45, 0x46, 0x38, 0x38, 0x45,
+    0x44, 0x45, 0x38, 0x3C, 0x41, 0x42, 0x20, 0x7C, 0x3C, 0x40, 0x42, 0x21,
+    0x7C, 0x3C, 0x42, 0x41, 0x22, 0x7C, 0x3C, 0x41, 0x40, 0x21, 0x7C,
+};
+
+static const pcd8544_glyph_t pcd8544_5x7_prop_glyphs[131] = {
+    {    0,  0,  3},  // 20 space
+    {    0,  1,  2},  // 21 !
+    {    8,  3,  4},  // 22 "
+    {   32,  5,  6},  // 23 #
+    {   72,  5,  6},  // 24 $
+    {  112,  5,  6},  // 25 %
+    {  152,  5,  6},  // 26 &
+    {  192,  2,  3},  // 27 '
+    {  208,  3,  4},  // 28 (
+    {  232,  3,  4},  // 29 )
+    {  256,  5,  6},  // 2a *
+    {  296,  5,  6},  // 2b +
+    {  336,  2,  3},  // 2c ,
+    {  352,  5,  6},  // 2d -
+    {  392,  2,  3},  // 2e .
+    {  408,  5,  6},  // 2f /
+    {  448,  5,  6},  // 30 0
+    {  488,  3,  4},  // 31 1
+    {  512,  5,  6},  // 32 2
+    {  552,  5,  6},  // 33 3
+    {  592,  5,  6},  // 34 4
+    {  632,  5,  6},  // 35 5
+    {  672,  5,  6},  // 36 6
+    {  712,  5,  6},  // 37 7
+    {  752,  5,  6},  // 38 8
+    {  792,  5,  6},  // 39 9
+    {  832,  2,  3},  // 3a :
+    {  848,  2,  3},  // 3b ;
+    {  864,  3,  4},  // 3c <
+    {  888,  5,  6},  // 3d =
+    {  928,  3,  4},  // 3e >
+    {  952,  5,  6},  // 3f ?
+    {  992,  5,  6},  // 40 @
+    { 1032,  5,  6},  // 41 A
+    { 1072,  5,  6},  // 42 B
+    { 1112,  5,  6},  // 43 C
+    { 1152,  5,  6},  // 44 D
+    { 1192,  5,  6},  // 45 E
+    { 1232,  5,  6},  // 46 F
+    { 1272,  5,  6},  // 47 G
+    { 1312,  5,  6},  // 48 H
+    { 1352,  3,  4},  // 49 I
+    { 1376,  5,  6},  // 4a J
+    { 1416,  5,  6},  // 4b K
+    { 1456,  5,  6},  // 4c L
+    { 1496,  5,  6},  // 4d M
+    { 1536,  5,  6},  // 4e N
+    { 1576,  5,  6},  // 4f O
+    { 1616,  5,  6},  // 50 P
+    { 1656,  5,  6},  // 51 Q
+    { 1696,  5,  6},  // 52 R
+    { 1736,  5,  6},  // 53 S
+    { 1776,  5,  6},  // 54 T
+    { 1816,  5,  6},  // 55 U
+    { 1856,  5,  6},  // 56 V
+    { 1896,  5,  6},  // 57 W
+    { 1936,  5,  6},  // 58 X
+    { 1976,  5,  6},  // 59 Y
+    { 2016,  5,  6},  // 5a Z
+    { 2056,  3,  4},  // 5b [
+    { 2080,  5,  6},  // 5c backslash
+    { 2120,  3,  4},  // 5d ]
+    { 2144,  5,  6},  // 5e ^
+    { 2184,  5,  6},  // 5f _
+    { 2224,  3,  4},  // 60 `
+    { 2248,  5,  6},  // 61 a
+    { 2288,  5,  6},  // 62 b
+    { 2328,  5,  6},  // 63 c
+    { 2368,  5,  6},  // 64 d
+    { 2408,  5,  6},  // 65 e
+    { 2448,  5,  6},  // 66 f
+    { 2488,  5,  6},  // 67 g
+    { 2528,  5,  6},  // 68 h
+    { 2568,  3,  4},  // 69 i
+    { 2592,  4,  5},  // 6a j
+    { 2624,  4,  5},  // 6b k
+    { 2656,  3,  4},  // 6c l
+    { 2680,  5,  6},  // 6d m
+    { 2720,  5,  6},  // 6e n
+    { 2760,  5,  6},  // 6f o
+    { 2800,  5,  6},  // 70 p
+    { 2840,  5,  6},  // 71 q
+    { 2880,  5,  6},  // 72 r
+    { 2920,  5,  6},  // 73 s
+    { 2960,  5,  6},  // 74 t
+    { 3000,  5,  6},  // 75 u
+    { 3040,  5,  6},  // 76 v
+    { 3080,  5,  6},  // 77 w
+    { 3120,  5,  6},  // 78 x
+    { 3160,  5,  6},  // 79 y
+    { 3200,  5,  6},  // 7a z
+    { 3240,  3,  4},  // 7b {
+    { 3264,  1,  2},  // 7c |
+    { 3272,  3,  4},  // 7d }
+    { 3296,  5,  6},  // 7e ~
+    { 3336,  1,  2},  // U+00A1
+    { 3344,  3,  4},  // U+00B0
+    { 3368,  5,  6},  // U+00BF
+    { 3408,  5,  6},  // U+00C4
+    { 3448,  5,  6},  // U+00C7
+    {    0,  0,  0},  // U+00C8
+    { 3488,  5,  6},  // U+00C9
+    { 3528,  5,  6},  // U+00D1
+    { 3568,  5,  6},  // U+00D6
+    { 3608,  5,  6},  // U+00DC
+    { 3648,  5,  6},  // U+00DF
+    { 3688,  5,  6},  // U+00E0
+    { 3728,  5,  6},  // U+00E1
+    { 3768,  5,  6},  // U+00E2
+    {    0,  0,  0},  // U+00E3
+    { 3808,  5,  6},  // U+00E4
+    { 3848,  5,  6},  // U+00E7
+    { 3888,  5,  6},  // U+00E8
+    { 3928,  5,  6},  // U+00E9
+    { 3968,  5,  6},  // U+00EA
+    { 4008,  5,  6},  // U+00EB
+    { 4048,  3,  4},  // U+00EC
+    { 4072,  3,  4},  // U+00ED
+    { 4096,  3,  4},  // U+00EE
+    { 4120,  3,  4},  // U+00EF
+    {    0,  0,  0},  // U+00F0
+    { 4144,  5,  6},  // U+00F1
+    { 4184,  5,  6},  // U+00F2
+    { 4224,  5,  6},  // U+00F3
+    { 4264,  5,  6},  // U+00F4
+    {    0,  0,  0},  // U+00F5
+    { 4304,  5,  6},  // U+00F6
+    { 4344,  5,  6},  // U+00F9
+    { 4384,  5,  6},  // U+00FA
+    { 4424,  5,  6},  // U+00FB
+    { 4464,  5,  6},  // U+00FC
+};
+
+static const pcd8544_glyph_range_t pcd8544_5x7_prop_ranges[12] = {
+    {0x0020, 0x007E,   0},
+    {0x00A1, 0x00A1,  95},
+    {0x00B0, 0x00B0,  96},
+    {0x00BF, 0x00BF,  97},
+    {0x00C4, 0x00C4,  98},
+    {0x00C7, 0x00C9,  99},
+    {0x00D1, 0x00D1, 102},
+    {0x00D6, 0x00D6, 103},
+    {0x00DC, 0x00DC, 104},
+    {0x00DF, 0x00E4, 105},
+    {0x00E7, 0x00F6, 111},
+    {0x00F9, 0x00FC, 127},
+};
+
+// pcd8544_font.py -n pcd8544_8x16_digits tools/fonts/digits_8x16.txt
+static const uint8_t pcd8544_8x16_digits_bitmap[172] = {
+    0x80, 0x01, 0x80, 0x01, 0xE0, 0x07, 0xE0, 0x07, 0x80, 0x01, 0x80, 0x01,
+    0x80, 0x01, 0x80, 0x01, 0x80, 0x01, 0x80, 0x01, 0x80, 0x01, 0x80, 0x01,
+    0x00, 0x60, 0x00, 0x60, 0xFC, 0x3F, 0xFE, 0x7F, 0x06, 0x60, 0x06, 0x60,
+    0x06, 0x60, 0xFE, 0x7F, 0xFC, 0x3F, 0x10, 0x60, 0x18, 0x60, 0x0C, 0x60,
+    0xFE, 0x7F, 0xFE, 0x7F, 0x00, 0x60, 0x00, 0x60, 0x0C, 0x7C, 0x0E, 0x7E,
+    0x06, 0x67, 0x86, 0x63, 0xC6, 0x61, 0xFE, 0x60, 0x7C, 0x60, 0x0C, 0x30,
+    0x0E, 0x70, 0x06, 0x60, 0xC6, 0x60, 0xC6, 0x60, 0xFE, 0x7F, 0x3C, 0x3F,
+    0xFE, 0x01, 0xFE, 0x01, 0x80, 0x01, 0x80, 0x01, 0x80, 0x01, 0xFE, 0x7F,
+    0xFE, 0x7F, 0xFE, 0x30, 0xFE, 0x70, 0xC6, 0x60, 0xC6, 0x60, 0xC6, 0x60,
+    0xC6, 0x7F, 0x86, 0x3F, 0xFC, 0x3F, 0xFE, 0x7F, 0xC6, 0x60, 0xC6, 0x60,
+    0xC6, 0x60, 0xCE, 0x7F, 0x8C, 0x3F, 0x06, 0x00, 0x06, 0x00, 0x06, 0x7E,
+    0x86, 0x7F, 0xE6, 0x01, 0x7E, 0x00, 0x1E, 0x00, 0x3C, 0x3F, 0xFE, 0x7F,
+    0xC6, 0x60, 0xC6, 0x60, 0xC6, 0x60, 0xFE, 0x7F, 0x3C, 0x3F, 0xFC, 0x30,
+    0xFE, 0x71, 0x86, 0x61, 0x86, 0x61, 0x86, 0x61, 0xFE, 0x7F, 0xFC, 0x3F,
+    0x30, 0x0C, 0x30, 0x0C,
+};
+
+static const pcd8544_glyph_t pcd8544_8x16_digits_glyphs[17] = {
+    {    0,  0,  8},  // 20 space
+    {    0,  6,  7},  // 2b +
+    {    0,  0,  0},  // 2c ,
+    {   96,  6,  7},  // 2d -
+    {  192,  2,  3},  // 2e .
+    {    0,  0,  0},  // 2f /
+    {  224,  7,  8},  // 30 0
+    {  336,  7,  8},  // 31 1
+    {  448,  7,  8},  // 32 2
+    {  560,  7,  8},  // 33 3
+    {  672,  7,  8},  // 34 4
+    {  784,  7,  8},  // 35 5
+    {  896,  7,  8},  // 36 6
+    { 1008,  7,  8},  // 37 7
+    { 1120,  7,  8},  // 38 8
+    { 1232,  7,  8},  // 39 9
+    { 1344,  2,  3},  // 3a :
+};
+
+static const pcd8544_glyph_range_t pcd8544_8x16_digits_ranges[2] = {
+    {0x0020, 0x0020,   0},
+    {0x002B, 0x003A,   1},
+};
+
+// pcd8544_font.py -n pcd8544_12x24_digits tools/fonts/digits_12x24.txt
+static const uint8_t pcd8544_12x24_digits_bitmap[402] = {
+    0x00, 0x1C, 0x00, 0x00, 0x1C, 0x00, 0x00, 0x1C, 0x00, 0x80, 0xFF, 0x00,
+    0x80, 0xFF, 0x00, 0x80, 0xFF, 0x00, 0x00, 0x1C, 0x00, 0x00, 0x1C, 0x00,
+    0x00, 0x1C, 0x00, 0x00, 0x1C, 0x00, 0x00, 0x1C, 0x00, 0x00, 0x1C, 0x00,
+    0x00, 0x1C, 0x00, 0x00, 0x1C, 0x00, 0x00, 0x1C, 0x00, 0x00, 0x1C, 0x00,
+    0x00, 0x1C, 0x00, 0x00, 0x1C, 0x00, 0x00, 0x00, 0x70, 0x00, 0x00, 0x70,
+    0x00, 0x00, 0x70, 0xFC, 0xFF, 0x3F, 0xFE, 0xFF, 0x7F, 0xFE, 0xFF, 0x7F,
+    0x0E, 0x00, 0x70, 0x0E, 0x00, 0x70, 0x0E, 0x00, 0x70, 0x0E, 0x00, 0x70,
+    0x0E, 0x00, 0x70, 0xFE, 0xFF, 0x7F, 0xFE, 0xFF, 0x7F, 0xFC, 0xFF, 0x3F,
+    0x00, 0x00, 0x70, 0x20, 0x00, 0x70, 0x30, 0x00, 0x70, 0x18, 0x00, 0x70,
+    0x0C, 0x00, 0x70, 0xFE, 0xFF, 0x7F, 0xFE, 0xFF, 0x7F, 0xFE, 0xFF, 0x7F,
+    0x00, 0x00, 0x70, 0x00, 0x00, 0x70, 0x00, 0x00, 0x70, 0x3C, 0x80, 0x7F,
+    0x3E, 0xC0, 0x7F, 0x3E, 0xC0, 0x7F, 0x0E, 0xF0, 0x71, 0x0E, 0xF0, 0x71,
+    0x0E, 0x7C, 0x70, 0x0E, 0x3E, 0x70, 0x0E, 0x3E, 0x70, 0xFE, 0x0F, 0x70,
+    0xFE, 0x0F, 0x70, 0xFC, 0x03, 0x70, 0x3C, 0x00, 0x3C, 0x3E, 0x00, 0x7C,
+    0x3E, 0x00, 0x7C, 0x0E, 0x00, 0x70, 0x0E, 0x00, 0x70, 0x0E, 0x0E, 0x70,
+    0x0E, 0x0E, 0x70, 0x0E, 0x0E, 0x70, 0xFE, 0xFF, 0x7F, 0xFE, 0xFF, 0x7F,
+    0xFC, 0xF1, 0x3F, 0xFE, 0x3F, 0x00, 0xFE, 0x3F, 0x00, 0xFE, 0x3F, 0x00,
+    0x00, 0x3C, 0x00, 0x00, 0x3C, 0x00, 0x00, 0x3C, 0x00, 0x00, 0x3C, 0x00,
+    0x00, 0x3C, 0x00, 0xFE, 0xFF, 0x7F, 0xFE, 0xFF, 0x7F, 0xFE, 0xFF, 0x7F,
+    0xFE, 0x0F, 0x3C, 0xFE, 0x0F, 0x7C, 0xFE, 0x0F, 0x7C, 0x0E, 0x0E, 0x70,
+    0x0E, 0x0E, 0x70, 0x0E, 0x0E, 0x70, 0x0E, 0x0E, 0x70, 0x0E, 0x0E, 0x70,
+    0x0E, 0xFE, 0x7F, 0x0E, 0xFE, 0x7F, 0x0E, 0xFC, 0x3F, 0xFC, 0xFF, 0x3F,
+    0xFE, 0xFF, 0x7F, 0xFE, 0xFF, 0x7F, 0x0E, 0x0E, 0x70, 0x0E, 0x0E, 0x70,
+    0x0E, 0x0E, 0x70, 0x0E, 0x0E, 0x70, 0x0E, 0x0E, 0x70, 0x3E, 0xFE, 0x7F,
+    0x3E, 0xFE, 0x7F, 0x3C, 0xFC, 0x3F, 0x0E, 0x00, 0x00, 0x0E, 0x00, 0x00,
+    0x0E, 0x00, 0x00, 0x0E, 0xC0, 0x7F, 0x0E, 0xF0, 0x7F, 0x0E, 0xFC, 0x7F,
+    0x0E, 0x3F, 0x00, 0xCE, 0x0F, 0x00, 0xFE, 0x03, 0x00, 0xFE, 0x00, 0x00,
+    0x3E, 0x00, 0x00, 0xFC, 0xF1, 0x3F, 0xFE, 0xFF, 0x7F, 0xFE, 0xFF, 0x7F,
+    0x0E, 0x0E, 0x70, 0x0E, 0x0E, 0x70, 0x0E, 0x0E, 0x70, 0x0E, 0x0E, 0x70,
+    0x0E, 0x0E, 0x70, 0xFE, 0xFF, 0x7F, 0xFE, 0xFF, 0x7F, 0xFC, 0xF1, 0x3F,
+    0xFC, 0x0F, 0x3C, 0xFE, 0x3F, 0x7C, 0xFE, 0x3F, 0x7C, 0x0E, 0x3C, 0x70,
+    0x0E, 0x3C, 0x70, 0x0E, 0x3C, 0x70, 0x0E, 0x3C, 0x70, 0x0E, 0x3C, 0x70,
+    0xFE, 0xFF, 0x7F, 0xFE, 0xFF, 0x7F, 0xFC, 0xFF, 0x3F, 0xC0, 0xC1, 0x01,
+    0xC0, 0xC1, 0x01, 0xC0, 0xC1, 0x01,
+};
+
+static const pcd8544_glyph_t pcd8544_12x24_digits_glyphs[17] = {
+    {    0,  0, 12},  // 20 space
+    {    0,  9, 10},  // 2b +
+    {    0,  0,  0},  // 2c ,
+    {  216,  9, 10},  // 2d -
+    {  432,  3,  4},  // 2e .
+    {    0,  0,  0},  // 2f /
+    {  504, 11, 12},  // 30 0
+    {  768, 11, 12},  // 31 1
+    { 1032, 11, 12},  // 32 2
+    { 1296, 11, 12},  // 33 3
+    { 1560, 11, 12},  // 34 4
+    { 1824, 11, 12},  // 35 5
+    { 2088, 11, 12},  // 36 6
+    { 2352, 11, 12},  // 37 7
+    { 2616, 11, 12},  // 38 8
+    { 2880, 11, 12},  // 39 9
+    { 3144,  3,  4},  // 3a :
+};
+
+static const pcd8544_glyph_range_t pcd8544_12x24_digits_ranges[2] = {
+    {0x0020, 0x0020,   0},
+    {0x002B, 0x003A,   1},
+};
+
 #endif /* __PCD8544_FONTS_H__ */
\ No newline at end of file
@@ -0,0 +1,484 @@
+#include <math.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "pcd8544.h"
+#include "pcd8544_priv.h"
+#include "sys/param.h"
+
+// Longest number the formatter builds: 64 bit octal with its prefix, or a
+// fixed-point number with 20 integer digits and 9 decimals
+#define PCD8544_NUM_MAX      32
+// Most decimals of %f and of pcd8544_put_fixed()
+#define PCD8544_DECIMALS_MAX 9
+// Limbs of 9 decimal digits the integer part of the largest double takes
+#define PCD8544_FLOAT_LIMBS  35
+
+#define PCD8544_FMT_LEFT  (1 << 0)  // '-'
+#define PCD8544_FMT_ZERO  (1 << 1)  // '0'
+#define PCD8544_FMT_PLUS  (1 << 2)  // '+'
+#define PCD8544_FMT_SPACE (1 << 3)  // ' '
+#define PCD8544_FMT_ALT   (1 << 4)  // '#'
+
+static const uint32_t pcd8544_pow10[PCD8544_DECIMALS_MAX + 1] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000,
+};
+
+// Write value into the end of buf with at least min_digits digits, and
+// return where the digits start. Octal and hex digits are shifted out, and
+// decimal ones divided out in 32 bits once the value fits, a 64 bit division
+// being a library call on 32 bit targets.
+static char* pcd8544_format_digits(char* end, uint64_t value, uint8_t base,
+                                   bool upper, uint8_t min_digits) {
+    const char* digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+    char*       p      = end;
+
+    if (base != 10) {
+        uint8_t shift = base == 16 ? 4 : 3;
+
+        while (value || min_digits) {
+            *--p  = digits[value & (base - 1)];
+            value >>= shift;
+            if (min_digits) min_digits--;
+        }
+        return p;
+    }
+
+    while (value > UINT32_MAX) {
+        *--p  = digits[value % 10];
+        value /= 10;
+        if (min_digits) min_digits--;
+    }
+
+    uint32_t low = value;
+
+    while (low || min_digits) {
+        *--p = digits[low % 10];
+        low /= 10;
+        if (min_digits) min_digits--;
+    }
+    return p;
+}
+
+static void pcd8544_format_pad(pcd8544_emit_t emit, void* ctx, char c,
+                               int len) {
+    static const char zeros[]  = "0000000000000000";
+    static const char spaces[] = "                ";
+    const char*       fill     = c == '0' ? zeros : spaces;
+
+    while (len > 0) {
+        int n = MIN(len, (int)sizeof(zeros) - 1);
+        emit(ctx, fill, n);
+        len -= n;
+    }
+}
+
+// Emit the padding before a body of body_len padded to width as the flags
+// say, and its prefix (sign, 0x). Zero padding goes between the prefix and the
+// body. Returns the padding that goes after the body.
+static int pcd8544_format_open(pcd8544_emit_t emit, void* ctx,
+                               const char* prefix, size_t prefix_len,
+                               size_t body_len, uint8_t flags, int width) {
+    int pad = width - (int)(prefix_len + body_len);
+
+    if (pad > 0 && !(flags & (PCD8544_FMT_LEFT | PCD8544_FMT_ZERO)))
+        pcd8544_format_pad(emit, ctx, ' ', pad);
+    if (prefix_len) emit(ctx, prefix, prefix_len);
+    if (pad > 0 && (flags & PCD8544_FMT_ZERO) && !(flags & PCD8544_FMT_LEFT))
+        pcd8544_format_pad(emit, ctx, '0', pad);
+    return pad > 0 && (flags & PCD8544_FMT_LEFT) ? pad : 0;
+}
+
+// Emit a prefix and a body padded to width, see pcd8544_format_open()
+static void pcd8544_format_field(pcd8544_emit_t emit, void* ctx,
+                                 const char* prefix, size_t prefix_len,
+                                 const char* body, size_t body_len,
+                                 uint8_t flags, int width) {
+    int pad = pcd8544_format_open(emit, ctx, prefix, prefix_len, body_len,
+                                  flags, width);
+
+    if (body_len) emit(ctx, body, body_len);
+    pcd8544_format_pad(emit, ctx, ' ', pad);
+}
+
+static char pcd8544_format_sign(bool negative, uint8_t flags) {
+    if (negative) return '-';
+    if (flags & PCD8544_FMT_PLUS) return '+';
+    if (flags & PCD8544_FMT_SPACE) return ' ';
+    return 0;
+}
+
+// Write a fixed-point number, value / 10^decimals, into the end of buf and
+// return where it starts
+static char* pcd8544_format_fixed(char* end, uint64_t value,
+                                  uint8_t decimals) {
+    char* p = end;
+
+    if (decimals) {
+        p    = pcd8544_format_digits(p, value % pcd8544_pow10[decimals], 10,
+                                     false, decimals);
+        *--p = '.';
+        value /= pcd8544_pow10[decimals];
+    }
+    return pcd8544_format_digits(p, value, 10, false, 1);
+}
+
+#ifdef CONFIG_PCD8544_FORMAT_FLOAT
+// Emit a value past what 64 bits of integer part hold. From 2^53 on a double
+// is a whole number, its mantissa is multiplied by its power of two in limbs
+// of 9 decimal digits, which gives the exact digits of the binary value like
+// printf(). Takes an IEEE 754 double.
+static void pcd8544_format_float_big(pcd8544_emit_t emit, void* ctx,
+                                     double value, char sign, uint8_t flags,
+                                     int width, int precision) {
+    char     buf[PCD8544_NUM_MAX];
+    char*    end = &buf[sizeof(buf)];
+    uint32_t limbs[PCD8544_FLOAT_LIMBS];  // Least significant first
+    uint8_t  n = 0;
+    uint64_t bits;
+
+    memcpy(&bits, &value, sizeof(bits));
+
+    uint64_t mantissa = (bits & ((1ULL << 52) - 1)) | (1ULL << 52);
+    int      exp      = (int)(bits >> 52 & 0x7FF) - 1075;
+
+    for (; mantissa; mantissa /= 1000000000)
+        limbs[n++] = mantissa % 1000000000;
+
+    // A limb shifted by 32 bits still fits in 64
+    while (exp > 0) {
+        uint8_t  shift = MIN(exp, 32);
+        uint64_t carry = 0;
+
+        for (uint8_t i = 0; i < n; i++) {
+            uint64_t limb = ((uint64_t)limbs[i] << shift) + carry;
+
+            limbs[i] = limb % 1000000000;
+            carry    = limb / 1000000000;
+        }
+        for (; carry; carry /= 1000000000) limbs[n++] = carry % 1000000000;
+        exp -= shift;
+    }
+
+    char*  top = pcd8544_format_digits(end, limbs[n - 1], 10, false, 1);
+    bool   dot = precision || (flags & PCD8544_FMT_ALT);
+    size_t len = (end - top) + (n - 1) * 9 + (dot ? 1 + precision : 0);
+    int    pad = pcd8544_format_open(emit, ctx, &sign, sign ? 1 : 0, len, flags,
+                                     width);
+
+    emit(ctx, top, end - top);
+    for (uint8_t i = n - 1; i-- > 0;)
+        emit(ctx, pcd8544_format_digits(end, limbs[i], 10, false, 9), 9);
+    if (dot) emit(ctx, ".", 1);
+    pcd8544_format_pad(emit, ctx, '0', precision);
+    pcd8544_format_pad(emit, ctx, ' ', pad);
+}
+
+static void pcd8544_format_float(pcd8544_emit_t emit, void* ctx, double value,
+                                 uint8_t flags, int width, int precision) {
+    char  buf[PCD8544_NUM_MAX];
+    char* end  = &buf[sizeof(buf)];
+    // -0.0 keeps its sign, like with printf()
+    bool  negative = signbit(value);
+    char  sign     = pcd8544_format_sign(negative, flags);
+
+    if (negative) value = -value;
+
+    if (isnan(value) || isinf(value)) {
+        pcd8544_format_field(emit, ctx, &sign, sign ? 1 : 0,
+                             isnan(value) ? "nan" : "inf", 3,
+                             flags & ~PCD8544_FMT_ZERO, width);
+        return;
+    }
+
+    if (precision < 0) precision = 6;
+    precision = MIN(precision, PCD8544_DECIMALS_MAX);
+
+    if (value >= 1e19) {
+        pcd8544_format_float_big(emit, ctx, value, sign, flags, width,
+                                 precision);
+        return;
+    }
+
+    // Rounded half up in double arithmetic, so the last decimal may be one
+    // off from printf(), which rounds the exact binary value
+    uint64_t integer  = value;
+    uint32_t fraction = (value - integer) * pcd8544_pow10[precision] + 0.5;
+
+    // Rounding the fraction up carries into the integer part
+    if (fraction >= pcd8544_pow10[precision]) {
+        fraction -= pcd8544_pow10[precision];
+        integer++;
+    }
+
+    char* p = pcd8544_format_digits(end, fraction, 10, false, precision);
+    if (precision || (flags & PCD8544_FMT_ALT)) *--p = '.';
+    p = pcd8544_format_digits(p, integer, 10, false, 1);
+
+    pcd8544_format_field(emit, ctx, &sign, sign ? 1 : 0, p, end - p, flags,
+                         width);
+}
+#endif
+
+void pcd8544_format(pcd8544_emit_t emit, void* ctx, const char* format,
+                    va_list arg) {
+    while (*format) {
+        // Text between conversions goes out as it is, in one piece
+        const char* percent = strchr(format, '%');
+        size_t      len = percent ? (size_t)(percent - format) : strlen(format);
+
+        if (len) emit(ctx, format, len);
+        if (!percent) return;
+
+        const char* spec      = percent;
+        uint8_t     flags     = 0;
+        int         width     = 0;
+        int         precision = -1;
+        // Argument size: 1 char, 2 short, 3 int, 4 long, 5 long long,
+        // 6 size_t / ptrdiff_t, 7 long double
+        uint8_t size = 3;
+
+        format = percent + 1;
+
+        for (;; format++) {
+            if (*format == '-')
+                flags |= PCD8544_FMT_LEFT;
+            else if (*format == '0')
+                flags |= PCD8544_FMT_ZERO;
+            else if (*format == '+')
+                flags |= PCD8544_FMT_PLUS;
+            else if (*format == ' ')
+                flags |= PCD8544_FMT_SPACE;
+            else if (*format == '#')
+                flags |= PCD8544_FMT_ALT;
+            else
+                break;
+        }
+
+        if (*format == '*') {
+            width = va_arg(arg, int);
+            if (width < 0) {
+                flags |= PCD8544_FMT_LEFT;
+                width = -width;
+            }
+            format++;
+        } else {
+            while (*format >= '0' && *format <= '9')
+                width = width * 10 + (*format++ - '0');
+        }
+
+        if (*format == '.') {
+            format++;
+            precision = 0;
+            if (*format == '*') {
+                precision = va_arg(arg, int);
+                format++;
+            } else {
+                while (*format >= '0' && *format <= '9')
+                    precision = precision * 10 + (*format++ - '0');
+            }
+        }
+
+        if (*format == 'h') {
+            size = 2;
+            if (*++format == 'h') {
+                size = 1;
+                format++;
+            }
+        } else if (*format == 'l') {
+            size = 4;
+            if (*++format == 'l') {
+                size = 5;
+                format++;
+            }
+        } else if (*format == 'z' || *format == 'j' || *format == 't') {
+            size = *format == 'j' ? 5 : 6;
+            format++;
+        } else if (*format == 'L') {
+            size = 7;
+            format++;
+        }
+
+        char        conv = *format;
+        char        buf[PCD8544_NUM_MAX];
+        char*       end = &buf[sizeof(buf)];
+        char*       digits;
+        const char* str;
+        char        prefix[2];
+        size_t      prefix_len = 0;
+
+        if (conv) format++;
+
+        switch (conv) {
+            case 'd':
+            case 'i': {
+                int64_t value;
+
+                if (size == 5)
+                    value = va_arg(arg, long long);
+                else if (size == 4)
+                    value = va_arg(arg, long);
+                else if (size == 6)
+                    value = va_arg(arg, ptrdiff_t);
+                else
+                    value = va_arg(arg, int);
+                if (size == 1) value = (signed char)value;
+                if (size == 2) value = (short)value;
+
+                uint64_t magnitude =
+                    value < 0 ? -(uint64_t)value : (uint64_t)value;
+                char     sign      = pcd8544_format_sign(value < 0, flags);
+
+                if (sign) prefix[prefix_len++] = sign;
+                if (precision >= 0) flags &= ~PCD8544_FMT_ZERO;
+                digits = pcd8544_format_digits(end, magnitude, 10, false,
+                                               precision < 0 ? 1 : precision);
+                pcd8544_format_field(emit, ctx, prefix, prefix_len, digits,
+                                     end - digits, flags, width);
+                break;
+            }
+
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'o':
+            case 'p': {
+                uint64_t value;
+                uint8_t  base = conv == 'u' ? 10 : conv == 'o' ? 8 : 16;
+
+                if (conv == 'p')
+                    value = (uintptr_t)va_arg(arg, void*);
+                else if (size == 5)
+                    value = va_arg(arg, unsigned long long);
+                else if (size == 4)
+                    value = va_arg(arg, unsigned long);
+                else if (size == 6)
+                    value = va_arg(arg, size_t);
+                else
+                    value = va_arg(arg, unsigned int);
+                if (size == 1) value = (unsigned char)value;
+                if (size == 2) value = (unsigned short)value;
+
+                if (precision >= 0) flags &= ~PCD8544_FMT_ZERO;
+                digits = pcd8544_format_digits(end, value, base, conv == 'X',
+                                               precision < 0 ? 1 : precision);
+
+                if (conv == 'p' || ((flags & PCD8544_FMT_ALT) && value &&
+                                    base == 16)) {
+                    prefix[prefix_len++] = '0';
+                    prefix[prefix_len++] = conv == 'X' ? 'X' : 'x';
+                } else if ((flags & PCD8544_FMT_ALT) && base == 8 &&
+                           *digits != '0') {
+                    *--digits = '0';
+                }
+                pcd8544_format_field(emit, ctx, prefix, prefix_len, digits,
+                                     end - digits, flags, width);
+                break;
+            }
+
+            case 'c':
+                buf[0] = (char)va_arg(arg, int);
+                pcd8544_format_field(emit, ctx, NULL, 0, buf, 1,
+                                     flags & ~PCD8544_FMT_ZERO, width);
+                break;
+
+            case 's':
+                str = va_arg(arg, const char*);
+                if (!str) str = "(null)";
+                // A precision bounds the length, the string may not end
+                len = precision < 0 ? strlen(str)
+                                    : strnlen(str, (size_t)precision);
+                pcd8544_format_field(emit, ctx, NULL, 0, str, len,
+                                     flags & ~PCD8544_FMT_ZERO, width);
+                break;
+
+#ifdef CONFIG_PCD8544_FORMAT_FLOAT
+            case 'f':
+            case 'F':
+                // A long double is narrowed, values past the range of a
+                // double are drawn as inf
+                pcd8544_format_float(emit, ctx,
+                                     size == 7 ? (double)va_arg(arg, long double)
+                                               : va_arg(arg, double),
+                                     flags, width, precision);
+                break;
+#else
+            case 'f':
+            case 'F':
+#endif
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+                // Not supported and left in the text as they are, but their
+                // argument is taken so the conversions after them line up
+                if (size == 7)
+                    (void)va_arg(arg, long double);
+                else
+                    (void)va_arg(arg, double);
+                emit(ctx, spec, format - spec);
+                break;
+
+            case 'n':
+                (void)va_arg(arg, void*);
+                emit(ctx, spec, format - spec);
+                break;
+
+            case '%':
+                emit(ctx, "%", 1);
+                break;
+
+            default:
+                // Unknown conversions are left in the text as they are
+                emit(ctx, spec, format - spec);
+                break;
+        }
+    }
+}
+
+// Draw value / 10^decimals right-aligned in width characters
+static esp_err_t pcd8544_put_number(pcd8544_handle_t*          handle,
+                                    const pcd8544_font_desc_t* font,
+                                    pcd8544_pixel_color_t color,
+                                    int32_t value, uint8_t decimals,
+                                    uint8_t width, char pad) {
+    if (!handle || !pcd8544_font_valid(font) ||
+        decimals > PCD8544_DECIMALS_MAX)
+        return ESP_ERR_INVALID_ARG;
+
+    char     buf[PCD8544_NUM_MAX];
+    char*    end       = &buf[sizeof(buf)];
+    uint32_t magnitude = value < 0 ? -(uint32_t)value : (uint32_t)value;
+    char*    p         = pcd8544_format_fixed(end, magnitude, decimals);
+    int      fill      = width - (int)(end - p) - (value < 0);
+
+    // Zeros go between the sign and the digits, other padding before both
+    if (value < 0 && pad != '0') *--p = '-';
+
+    PCD8544_LOCK(handle);
+    if (value < 0 && pad == '0') pcd8544_draw_glyph(handle, font, color, '-');
+    for (; fill > 0; fill--)
+        pcd8544_draw_glyph(handle, font, color, (uint8_t)pad);
+    for (; p < end; p++) pcd8544_draw_glyph(handle, font, color, *p);
+    PCD8544_UNLOCK(handle);
+
+    return ESP_OK;
+}
+
+esp_err_t pcd8544_put_int(pcd8544_handle_t*          handle,
+                          const pcd8544_font_desc_t* font,
+                          pcd8544_pixel_color_t color, int32_t value,
+                          uint8_t width, char pad) {
+    return pcd8544_put_number(handle, font, color, value, 0, width, pad);
+}
+
+esp_err_t pcd8544_put_fixed(pcd8544_handle_t*          handle,
+                            const pcd8544_font_desc_t* font,
+                            pcd8544_pixel_color_t color, int32_t value,
+                            uint8_t decimals, uint8_t width, char pad) {
+    return pcd8544_put_number(handle, font, color, value, decimals, width,
+                              pad);
+}
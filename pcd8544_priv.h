@@ -0,0 +1,220 @@
+#ifndef __PCD8544_PRIV_H__
+#define __PCD8544_PRIV_H__
+
+// Internals shared by the source files of the driver, not part of the API
+
+#include <stdarg.h>
+
+#include "driver/ledc.h"
+#include "driver/spi_master.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "pcd8544.h"
+
+#define PCD8544_BANK_NUM        (PCD8544_V_RES_MAX / 8)
+// Runs a single flush is split into, the rest is merged into the last one
+#define PCD8544_SPAN_MAX        16
+// Every span of an async flush takes an address and a data transaction
+#define PCD8544_ASYNC_TRANS_MAX (PCD8544_SPAN_MAX * 2)
+
+// Drawing calls lock the display themselves only when configured to, batches
+// of calls can always be locked with pcd8544_begin() / pcd8544_end()
+#ifdef CONFIG_PCD8544_LOCK_EACH_CALL
+#define PCD8544_LOCK(h)   xSemaphoreTakeRecursive((h)->lock, portMAX_DELAY)
+#define PCD8544_UNLOCK(h) xSemaphoreGiveRecursive((h)->lock)
+#else
+#define PCD8544_LOCK(h)
+#define PCD8544_UNLOCK(h)
+#endif
+
+// Per-device state of a transaction, pointed to by its user field
+typedef struct {
+    pcd8544_handle_t* handle;
+    uint32_t          dc;  // D/C line level
+} pcd8544_trans_ctx_t;
+
+struct pcd8544_handle_t {
+    uint8_t                buffer[PCD8544_BUFFER_SIZE];
+    uint8_t                dirty_xmin[PCD8544_BANK_NUM];
+    uint8_t                dirty_xmax[PCD8544_BANK_NUM];
+    uint8_t                _x;
+    uint8_t                _y;
+    bool                   is_inverted;
+    ledc_channel_config_t* backlight_pwm;
+    pcd8544_io_config_t*   io;
+    spi_device_handle_t    spi_handle;
+    pcd8544_trans_ctx_t    cmd_ctx;
+    pcd8544_trans_ctx_t    data_ctx;
+    pcd8544_stats_t        stats;
+    SemaphoreHandle_t      lock;  // Guards the buffer and the dirty spans
+    // Guards everything sent to the controller: the transfers themselves,
+    // ram_next and the async transactions. Taken after lock when both are
+    // needed, drawing in terminal mode holds lock while it sends.
+    SemaphoreHandle_t      xfer_lock;
+
+    // Copy of the controller RAM as of the last flush. Flushes only send the
+    // bytes of the buffer that differ from it, and send them from here so
+    // drawing can continue into the buffer while an async flush is in flight.
+    uint8_t*                shadow;
+    // False before the first flush and after a failed transfer, the next
+    // flush then sends the whole buffer
+    bool                    shadow_valid;
+    spi_transaction_t       async_trans[PCD8544_ASYNC_TRANS_MAX];
+    uint8_t                 async_queued;
+    spi_transaction_t*      async_last;
+    pcd8544_flush_done_cb_t async_cb;
+    void*                   async_cb_ctx;
+
+    // Characters of the 5x7 font on bank-aligned rows are written straight
+    // to the controller RAM, see pcd8544_set_terminal_mode()
+    bool     terminal_mode;
+    uint16_t ram_next;  // Offset the controller writes next, or UINT16_MAX
+
+    // Smooth scroll in progress, taken while the animation task runs
+    SemaphoreHandle_t scroll_idle;
+    int8_t            scroll_dx;
+    int8_t            scroll_dy;
+    int               scroll_time_ms;
+
+    // Render task, flushes the buffer at the configured frame rate
+    TaskHandle_t       render_task;
+    EventGroupHandle_t render_events;
+    volatile bool      render_stop;
+
+    // Template the buffer was last restored from, forgotten by any other
+    // drawing, see pcd8544_update_area()
+    const pcd8544_template_t* shown_template;
+    uint32_t                  shown_revision;
+
+    // Animation player, see pcd8544_anim.c. The fields are guarded by lock,
+    // anim_idle is taken while the player task runs.
+    SemaphoreHandle_t     anim_idle;
+    TaskHandle_t          anim_task;
+    const pcd8544_anim_t* anim;
+    size_t                anim_next;   // Frame to show next
+    size_t                anim_shown;  // Frame in the buffer, SIZE_MAX if none
+    bool                  anim_loop;
+    bool                  anim_paused;
+    bool                  anim_seek;  // Show anim_next right away
+    bool                  anim_stop;
+};
+
+// Drawing helpers of pcd8544.c. They neither check the handle nor lock it,
+// the public calls do that once around them.
+
+// Widen the dirty column span of every bank the area touches
+void pcd8544_update_area(pcd8544_handle_t* handle, uint8_t xMin, uint8_t yMin,
+                         uint8_t xMax, uint8_t yMax);
+
+// Sort the corners of an area and clip it to the display. Returns false when
+// nothing of it is visible.
+bool pcd8544_clip_area(uint8_t* x0, uint8_t* y0, uint8_t* x1, uint8_t* y1);
+
+// Fill a clipped area a byte at a time, without updating the dirty area
+void pcd8544_fill_span(pcd8544_handle_t* handle, uint8_t x0, uint8_t y0,
+                       uint8_t x1, uint8_t y1, pcd8544_pixel_color_t color);
+
+// Clip and fill an area, and update the dirty area
+void pcd8544_fill_area(pcd8544_handle_t* handle, uint8_t x0, uint8_t y0,
+                       uint8_t x1, uint8_t y1, pcd8544_pixel_color_t color);
+
+// Apply a color to the pixels of bits in a buffer byte. area holds the
+// pixels the drawing covers, a copy clears the ones of them not in bits.
+static inline void pcd8544_rop(uint8_t* p, uint8_t bits, uint8_t area,
+                               pcd8544_pixel_color_t color) {
+    switch (color) {
+        case PCD8544_PIXEL_WHITE:
+            *p &= ~bits;
+            break;
+        case PCD8544_PIXEL_XOR:
+            *p ^= bits;
+            break;
+        case PCD8544_PIXEL_COPY:
+            *p = (*p & ~area) | bits;
+            break;
+        default:
+            *p |= bits;
+            break;
+    }
+}
+
+// Draw the set bits of a column byte with its top row at y, without updating
+// the dirty area. area holds the rows of the byte that are drawn, see
+// pcd8544_rop().
+void pcd8544_blit_byte(pcd8544_handle_t* handle, uint8_t x, uint8_t y,
+                       uint8_t bits, uint8_t area,
+                       pcd8544_pixel_color_t color);
+
+// Whether a pcd8544_font_t is one of the fonts. The functions below take only
+// fonts that are, the public calls check theirs.
+bool pcd8544_font_exists(pcd8544_font_t font);
+
+// Size of a character cell of the font, spacing included
+void pcd8544_font_cell(pcd8544_font_t font, uint8_t* width, uint8_t* height);
+
+// Descriptor of a pcd8544_font_t font
+const pcd8544_font_desc_t* pcd8544_font_desc(pcd8544_font_t font);
+
+// Find the glyph of a code point, false when the font has none
+bool pcd8544_font_glyph(const pcd8544_font_desc_t* font, uint32_t code,
+                        pcd8544_glyph_t* glyph);
+
+// Draw the glyph of a code point at the cursor and advance it
+void pcd8544_draw_glyph(pcd8544_handle_t*          handle,
+                        const pcd8544_font_desc_t* font,
+                        pcd8544_pixel_color_t color, uint32_t code);
+
+// Whether a font descriptor can be drawn
+bool pcd8544_font_valid(const pcd8544_font_desc_t* font);
+
+// Decode the UTF-8 sequence at *str and move past it, without reading from
+// end on. A malformed sequence decodes to U+FFFD and is skipped up to the
+// first byte that does not fit.
+uint32_t pcd8544_utf8_next(const char** str, const char* end);
+
+// Draw len bytes of UTF-8 text at the cursor and advance it
+void pcd8544_draw_utf8(pcd8544_handle_t*          handle,
+                       const pcd8544_font_desc_t* font,
+                       pcd8544_pixel_color_t color, const char* str,
+                       size_t len);
+
+// Draw a character at the cursor and advance it
+void pcd8544_draw_char(pcd8544_handle_t* handle, pcd8544_font_t font,
+                       pcd8544_pixel_color_t color, char c);
+
+// Draw a pixel, pixels outside of the display are ignored
+void pcd8544_plot(pcd8544_handle_t* handle, uint8_t x, uint8_t y,
+                  pcd8544_pixel_color_t color);
+
+void pcd8544_line(pcd8544_handle_t* handle, uint8_t x0, uint8_t y0, uint8_t x1,
+                  uint8_t y1, pcd8544_pixel_color_t color);
+
+void pcd8544_rectangle(pcd8544_handle_t* handle, uint8_t x0, uint8_t y0,
+                       uint8_t x1, uint8_t y1, pcd8544_pixel_color_t color,
+                       bool filled);
+
+void pcd8544_circle(pcd8544_handle_t* handle, uint8_t x0, uint8_t y0, uint8_t r,
+                    pcd8544_pixel_color_t color, bool filled);
+
+// Shift the content of an area, pixels shifted in are white
+void pcd8544_shift_area(pcd8544_handle_t* handle, uint8_t x0, uint8_t y0,
+                        uint8_t x1, uint8_t y1, int8_t dx, int8_t dy);
+
+// Draw the calls recorded in a display list, see pcd8544_dlist.c
+void pcd8544_dlist_replay(pcd8544_handle_t*      handle,
+                          const pcd8544_dlist_t* dlist);
+
+// Takes the text of pcd8544_format() a piece at a time
+typedef void (*pcd8544_emit_t)(void* ctx, const char* str, size_t len);
+
+// Format like vprintf(), passing the text to emit as it is produced instead
+// of into a buffer. Supports the flags, width, precision and length modifiers
+// of printf with the d i u x X o p c s % conversions, and f F when
+// CONFIG_PCD8544_FORMAT_FLOAT is set. Other conversions are passed on as
+// they are written, their argument is skipped. See pcd8544_format.c.
+void pcd8544_format(pcd8544_emit_t emit, void* ctx, const char* format,
+                    va_list arg);
+
+#endif /* __PCD8544_PRIV_H__ */
@@ -0,0 +1,75 @@
+#include <string.h>
+
+#include "pcd8544.h"
+#include "pcd8544_priv.h"
+#include "sys/param.h"
+
+// Every run starts with a control byte, the top two bits are the kind of run
+// and the low six bits its length minus one. The runs walk the buffer in its
+// own order, bank by bank, from byte 0. See tools/pcd8544_encode.py.
+#define PCD8544_RLE_KIND_MASK 0xC0
+#define PCD8544_RLE_SKIP      0x00  // Leave bytes as they are
+#define PCD8544_RLE_REPEAT    0x40  // One data byte, repeated
+#define PCD8544_RLE_LITERAL   0x80  // As many data bytes as the length
+#define PCD8544_RLE_LEN(c)    (((c) & 0x3F) + 1)
+
+esp_err_t pcd8544_draw_rle(pcd8544_handle_t* handle, const uint8_t* data,
+                           size_t len) {
+    if (!handle || (!data && len)) return ESP_ERR_INVALID_ARG;
+
+    esp_err_t ret = ESP_OK;
+    uint8_t   xmin[PCD8544_BANK_NUM];
+    uint8_t   xmax[PCD8544_BANK_NUM];
+    uint16_t  pos = 0;
+    size_t    i   = 0;
+
+    memset(xmin, PCD8544_H_RES_MAX - 1, sizeof(xmin));
+    memset(xmax, 0, sizeof(xmax));
+
+    PCD8544_LOCK(handle);
+    while (i < len) {
+        uint8_t kind = data[i] & PCD8544_RLE_KIND_MASK;
+        uint8_t n    = PCD8544_RLE_LEN(data[i]);
+        i++;
+
+        if (pos + n > PCD8544_BUFFER_SIZE) {
+            ret = ESP_ERR_INVALID_SIZE;
+            break;
+        }
+        if (kind == PCD8544_RLE_SKIP) {
+            pos += n;
+            continue;
+        }
+        if (kind != PCD8544_RLE_REPEAT && kind != PCD8544_RLE_LITERAL) {
+            ret = ESP_ERR_INVALID_ARG;
+            break;
+        }
+        if (i + (kind == PCD8544_RLE_REPEAT ? 1 : n) > len) {
+            ret = ESP_ERR_INVALID_SIZE;
+            break;
+        }
+
+        // Only bytes that really change widen the dirty span of their bank,
+        // a run may cross into the next bank
+        for (uint8_t k = 0; k < n; k++, pos++) {
+            uint8_t byte = kind == PCD8544_RLE_REPEAT ? data[i] : data[i + k];
+            if (handle->buffer[pos] == byte) continue;
+
+            uint8_t bank = pos / PCD8544_H_RES_MAX;
+            uint8_t x    = pos % PCD8544_H_RES_MAX;
+
+            handle->buffer[pos] = byte;
+            xmin[bank]          = MIN(xmin[bank], x);
+            xmax[bank]          = MAX(xmax[bank], x);
+        }
+        i += kind == PCD8544_RLE_REPEAT ? 1 : n;
+    }
+
+    for (uint8_t bank = 0; bank < PCD8544_BANK_NUM; bank++)
+        if (xmin[bank] <= xmax[bank])
+            pcd8544_update_area(handle, xmin[bank], bank * 8, xmax[bank],
+                                bank * 8 + 7);
+    PCD8544_UNLOCK(handle);
+
+    return ret;
+}
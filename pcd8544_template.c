@@ -0,0 +1,197 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "pcd8544.h"
+#include "pcd8544_priv.h"
+
+typedef struct {
+    uint8_t                 x0;
+    uint8_t                 y0;
+    uint8_t                 x1;
+    uint8_t                 y1;
+    pcd8544_field_draw_cb_t draw_cb;
+    void*                   user_ctx;
+    uint8_t                 value[PCD8544_FIELD_VALUE_MAX];
+    uint8_t                 value_len;
+    bool                    changed;  // Value set since the field was drawn
+} pcd8544_field_t;
+
+struct pcd8544_template_t {
+    uint8_t         image[PCD8544_BUFFER_SIZE];
+    uint32_t        revision;
+    uint8_t         field_num;
+    uint8_t         field_max;
+    pcd8544_field_t fields[];
+};
+
+// Every new image gets a revision of its own, so a display never mistakes a
+// changed or reallocated template for the one it shows
+static uint32_t s_revision;
+
+static void pcd8544_template_touch(pcd8544_template_t* tmpl) {
+    tmpl->revision = ++s_revision;
+}
+
+// Copy the template back into the area of a field. Banks the area only
+// partly covers are merged through a mask, so the rows of a field above or
+// below in the same bank are left alone.
+static void pcd8544_restore_field(pcd8544_handle_t*         handle,
+                                  const pcd8544_template_t* tmpl,
+                                  const pcd8544_field_t*    field) {
+    uint8_t width = field->x1 - field->x0 + 1;
+
+    for (uint8_t bank = field->y0 / 8; bank <= field->y1 / 8; bank++) {
+        uint8_t top    = bank == field->y0 / 8 ? field->y0 % 8 : 0;
+        uint8_t bottom = bank == field->y1 / 8 ? field->y1 % 8 : 7;
+        uint8_t mask   = (0xFF << top) & (0xFF >> (7 - bottom));
+
+        uint16_t       offset = bank * PCD8544_H_RES_MAX + field->x0;
+        uint8_t*       dst    = &handle->buffer[offset];
+        const uint8_t* src    = &tmpl->image[offset];
+
+        if (mask == 0xFF) {
+            memcpy(dst, src, width);
+            continue;
+        }
+        for (uint8_t i = 0; i < width; i++)
+            dst[i] = (dst[i] & ~mask) | (src[i] & mask);
+    }
+
+    pcd8544_update_area(handle, field->x0, field->y0, field->x1, field->y1);
+}
+
+esp_err_t pcd8544_template_create(uint8_t              max_fields,
+                                  pcd8544_template_t** ret_tmpl) {
+    if (!ret_tmpl) return ESP_ERR_INVALID_ARG;
+
+    pcd8544_template_t* tmpl = calloc(
+        1, sizeof(pcd8544_template_t) + max_fields * sizeof(pcd8544_field_t));
+    if (!tmpl) return ESP_ERR_NO_MEM;
+
+    tmpl->field_max = max_fields;
+    pcd8544_template_touch(tmpl);
+
+    *ret_tmpl = tmpl;
+    return ESP_OK;
+}
+
+esp_err_t pcd8544_template_delete(pcd8544_template_t* tmpl) {
+    if (!tmpl) return ESP_ERR_INVALID_ARG;
+    free(tmpl);
+    return ESP_OK;
+}
+
+esp_err_t pcd8544_template_set_image(pcd8544_template_t* tmpl,
+                                     const uint8_t*      bitmap) {
+    if (!tmpl || !bitmap) return ESP_ERR_INVALID_ARG;
+
+    memcpy(tmpl->image, bitmap, PCD8544_BUFFER_SIZE);
+    pcd8544_template_touch(tmpl);
+    return ESP_OK;
+}
+
+esp_err_t pcd8544_template_render(pcd8544_template_t*    tmpl,
+                                  const pcd8544_dlist_t* dlist) {
+    if (!tmpl || !dlist) return ESP_ERR_INVALID_ARG;
+
+    // The drawing helpers only need the buffer and the cursor of a handle,
+    // a blank one that is never initialized does as a canvas
+    pcd8544_handle_t* canvas = calloc(1, sizeof(pcd8544_handle_t));
+    if (!canvas) return ESP_ERR_NO_MEM;
+
+    pcd8544_dlist_replay(canvas, dlist);
+    memcpy(tmpl->image, canvas->buffer, PCD8544_BUFFER_SIZE);
+    free(canvas);
+
+    pcd8544_template_touch(tmpl);
+    return ESP_OK;
+}
+
+esp_err_t pcd8544_template_capture(pcd8544_template_t* tmpl,
+                                   pcd8544_handle_t*   handle) {
+    if (!tmpl || !handle) return ESP_ERR_INVALID_ARG;
+
+    PCD8544_LOCK(handle);
+    memcpy(tmpl->image, handle->buffer, PCD8544_BUFFER_SIZE);
+    PCD8544_UNLOCK(handle);
+
+    pcd8544_template_touch(tmpl);
+    return ESP_OK;
+}
+
+esp_err_t pcd8544_template_add_field(pcd8544_template_t* tmpl, uint8_t x0,
+                                     uint8_t y0, uint8_t x1, uint8_t y1,
+                                     pcd8544_field_draw_cb_t draw_cb,
+                                     void* user_ctx, uint8_t* ret_id) {
+    if (!tmpl || !draw_cb) return ESP_ERR_INVALID_ARG;
+    if (!pcd8544_clip_area(&x0, &y0, &x1, &y1)) return ESP_ERR_INVALID_ARG;
+    if (tmpl->field_num == tmpl->field_max) return ESP_ERR_NO_MEM;
+
+    pcd8544_field_t* field = &tmpl->fields[tmpl->field_num];
+
+    field->x0        = x0;
+    field->y0        = y0;
+    field->x1        = x1;
+    field->y1        = y1;
+    field->draw_cb   = draw_cb;
+    field->user_ctx  = user_ctx;
+    field->value_len = 0;
+    field->changed   = true;
+
+    if (ret_id) *ret_id = tmpl->field_num;
+    tmpl->field_num++;
+    return ESP_OK;
+}
+
+esp_err_t pcd8544_template_set_field(pcd8544_template_t* tmpl, uint8_t id,
+                                     const void* value, size_t len) {
+    if (!tmpl || id >= tmpl->field_num) return ESP_ERR_INVALID_ARG;
+    if ((!value && len) || len > PCD8544_FIELD_VALUE_MAX)
+        return ESP_ERR_INVALID_ARG;
+
+    pcd8544_field_t* field = &tmpl->fields[id];
+
+    // Setting the value the field already shows costs nothing at the next draw
+    if (len == field->value_len && memcmp(field->value, value, len) == 0)
+        return ESP_OK;
+
+    memcpy(field->value, value, len);
+    field->value_len = len;
+    field->changed   = true;
+    return ESP_OK;
+}
+
+esp_err_t pcd8544_draw_template(pcd8544_handle_t*   handle,
+                                pcd8544_template_t* tmpl) {
+    if (!handle || !tmpl) return ESP_ERR_INVALID_ARG;
+
+    PCD8544_LOCK(handle);
+
+    // Switching to the template, or coming back to it after other drawing,
+    // copies all of it; after that only the fields whose value changed are
+    // restored and drawn again
+    bool full = handle->shown_template != tmpl ||
+                handle->shown_revision != tmpl->revision;
+    if (full) {
+        memcpy(handle->buffer, tmpl->image, PCD8544_BUFFER_SIZE);
+        pcd8544_update_area(handle, 0, 0, PCD8544_H_RES_MAX - 1,
+                            PCD8544_V_RES_MAX - 1);
+    }
+
+    for (uint8_t i = 0; i < tmpl->field_num; i++) {
+        pcd8544_field_t* field = &tmpl->fields[i];
+
+        if (!full && !field->changed) continue;
+        if (!full) pcd8544_restore_field(handle, tmpl, field);
+
+        field->changed = false;
+        field->draw_cb(handle, field->value, field->value_len,
+                       field->user_ctx);
+    }
+
+    // Set after the fields, their drawing forgets the template like any other
+    handle->shown_template = tmpl;
+    handle->shown_revision = tmpl->revision;
+    PCD8544_UNLOCK(handle);
+    return ESP_OK;
+}
@@ -0,0 +1,221 @@
+#!/usr/bin/env python3
+"""Encode 84 x 48 images into the RLE format of pcd8544_draw_rle().
+
+Every run starts with a control byte: the top two bits are the kind of run,
+the low six bits its length minus one (1 ~ 64 bytes).
+
+    00 SKIP     leave the bytes as they are
+    01 REPEAT   one data byte follows, repeated
+    10 LITERAL  as many data bytes as the length follow
+
+Runs walk the 504 byte frame buffer in its own order: 6 banks of 84 column
+bytes, bit 0 of a byte on top. The first frame is encoded whole, with
+--delta every following frame only encodes the bytes that differ from the
+frame before it, so drawing it over that frame turns it into the new one.
+
+Input files are raw 504 byte frames (.bin) or PBM images (.pbm, P1 or P4).
+Other image formats are read through Pillow when it is installed. The output
+is a C header with one array per frame.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+WIDTH = 84
+HEIGHT = 48
+BANKS = HEIGHT // 8
+BUFFER_SIZE = WIDTH * BANKS
+
+RUN_MAX = 64
+SKIP = 0x00
+REPEAT = 0x40
+LITERAL = 0x80
+
+
+def pixels_to_frame(pixels):
+    """Pack rows of 0 / 1 pixels (1 is black) into the display byte layout."""
+    frame = bytearray(BUFFER_SIZE)
+    for y in range(HEIGHT):
+        for x in range(WIDTH):
+            if pixels[y][x]:
+                frame[(y // 8) * WIDTH + x] |= 1 << (y % 8)
+    return frame
+
+
+def read_pbm(data):
+    # Header fields are separated by whitespace, comments run to end of line
+    fields = []
+    pos = 0
+    while len(fields) < 3:
+        match = re.compile(rb"\s*(#[^\n]*\n\s*)*(\S+)").match(data, pos)
+        if not match:
+            raise ValueError("truncated PBM header")
+        fields.append(match.group(2))
+        pos = match.end()
+    magic, width, height = fields[0], int(fields[1]), int(fields[2])
+    if (width, height) != (WIDTH, HEIGHT):
+        raise ValueError("image is %dx%d, not %dx%d" %
+                         (width, height, WIDTH, HEIGHT))
+
+    if magic == b"P4":
+        stride = (width + 7) // 8
+        raster = data[pos + 1:]
+        return [[(raster[y * stride + x // 8] >> (7 - x % 8)) & 1
+                 for x in range(width)] for y in range(height)]
+    if magic == b"P1":
+        bits = [b for b in data[pos:] if b in b"01"]
+        return [[bits[y * width + x] - ord("0") for x in range(width)]
+                for y in range(height)]
+    raise ValueError("not a PBM image")
+
+
+def read_image(path):
+    with open(path, "rb") as f:
+        data = f.read()
+
+    if path.endswith(".bin"):
+        if len(data) != BUFFER_SIZE:
+            raise ValueError("raw frame must be %d bytes" % BUFFER_SIZE)
+        return bytearray(data)
+    if data[:2] in (b"P1", b"P4"):
+        return pixels_to_frame(read_pbm(data))
+
+    try:
+        from PIL import Image
+    except ImportError:
+        raise ValueError("unknown format, install Pillow to read it")
+    image = Image.open(path).convert("1")
+    if image.size != (WIDTH, HEIGHT):
+        raise ValueError("image is %dx%d, not %dx%d" %
+                         (image.size + (WIDTH, HEIGHT)))
+    # Dark pixels are black on the display
+    return pixels_to_frame([[int(image.getpixel((x, y)) == 0)
+                             for x in range(WIDTH)] for y in range(HEIGHT)])
+
+
+def encode(frame, prev=None):
+    """Encode a frame, only the bytes that differ from prev if given."""
+    out = bytearray()
+    literal = bytearray()
+
+    def flush_literal():
+        for i in range(0, len(literal), RUN_MAX):
+            chunk = literal[i:i + RUN_MAX]
+            out.append(LITERAL | (len(chunk) - 1))
+            out.extend(chunk)
+        del literal[:]
+
+    pos = 0
+    while pos < BUFFER_SIZE:
+        if prev is not None and frame[pos] == prev[pos]:
+            end = pos
+            while end < BUFFER_SIZE and frame[end] == prev[end]:
+                end += 1
+            # Nothing left to change, the rest of the frame is left as is
+            if end == BUFFER_SIZE:
+                break
+            # A short skip between two literals costs more than it saves
+            if end - pos > 1 or not literal:
+                flush_literal()
+                for i in range(pos, end, RUN_MAX):
+                    out.append(SKIP | (min(RUN_MAX, end - i) - 1))
+            else:
+                literal.extend(frame[pos:end])
+            pos = end
+            continue
+
+        end = pos
+        while end < BUFFER_SIZE and frame[end] == frame[pos]:
+            end += 1
+        # Repeats shorter than 3 bytes are no smaller than a literal
+        if end - pos >= 3:
+            flush_literal()
+            for i in range(pos, end, RUN_MAX):
+                out.append(REPEAT | (min(RUN_MAX, end - i) - 1))
+                out.append(frame[pos])
+            pos = end
+        else:
+            literal.append(frame[pos])
+            pos += 1
+
+    flush_literal()
+    return out
+
+
+def decode(data, frame):
+    """Reference decoder, used to check every encoded frame."""
+    pos = i = 0
+    while i < len(data):
+        kind, n = data[i] & 0xC0, (data[i] & 0x3F) + 1
+        i += 1
+        if kind == REPEAT:
+            frame[pos:pos + n] = bytes([data[i]]) * n
+            i += 1
+        elif kind == LITERAL:
+            frame[pos:pos + n] = data[i:i + n]
+            i += n
+        pos += n
+    return frame
+
+
+def c_array(name, data):
+    lines = ["static const uint8_t %s[%d] = {" % (name, len(data))]
+    for i in range(0, len(data), 12):
+        lines.append("    " + ", ".join("0x%02X" % b for b in data[i:i + 12])
+                     + ",")
+    lines.append("};")
+    return "\n".join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Encode 84x48 images for pcd8544_draw_rle().")
+    parser.add_argument("images", nargs="+", help="frames, in order")
+    parser.add_argument("-n", "--name", default="image",
+                        help="name prefix of the C arrays")
+    parser.add_argument("-o", "--output", help="header file, default stdout")
+    parser.add_argument("--delta", action="store_true",
+                        help="encode frames after the first as deltas")
+    args = parser.parse_args()
+
+    if not re.match(r"^[A-Za-z_]\w*$", args.name):
+        parser.error("name must be a C identifier")
+
+    arrays = []
+    total = 0
+    prev = None
+    for index, path in enumerate(args.images):
+        try:
+            frame = read_image(path)
+        except (OSError, ValueError) as e:
+            sys.exit("%s: %s" % (path, e))
+
+        data = encode(frame, prev if args.delta else None)
+        base = bytearray(prev if args.delta and prev else BUFFER_SIZE)
+        assert decode(data, base) == frame
+
+        name = args.name if len(args.images) == 1 else \
+            "%s_%d" % (args.name, index)
+        arrays.append("// %s, %d bytes\n%s" %
+                      (os.path.basename(path), len(data), c_array(name, data)))
+        total += len(data)
+        prev = frame
+
+    guard = "__%s_H__" % args.name.upper()
+    header = "\n\n".join(
+        ["// Generated by pcd8544_encode.py, %d frames in %d bytes (%d raw)" %
+         (len(args.images), total, len(args.images) * BUFFER_SIZE),
+         "#ifndef %s\n#define %s\n\n#include <stdint.h>" % (guard, guard)]
+        + arrays + ["#endif /* %s */\n" % guard])
+
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(header)
+    else:
+        sys.stdout.write(header)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,349 @@
+#!/usr/bin/env python3
+"""Convert bitmap fonts into the font descriptors of pcd8544_putc_font().
+
+Glyphs are packed column after column, left to right, each column taking
+exactly as many bits as the font is high, top row first. All columns of all
+glyphs form one stream of bits, running from bit 0 of the first byte up, so
+a column of a 12 row font takes 12 bits instead of two column bytes.
+
+Fonts are read from BDF files, or from text files drawing every glyph with
+'#' for a set pixel and '.' for a clear one:
+
+    # Comments run to end of line
+    height 16           rows of every glyph, the line height as well
+    spacing 1           blank columns after every glyph
+
+    char '0'            or a code point, like char 0x30 or char U+00E9
+    .#####.
+    ...                 as many rows as the height
+
+The output is a C header with the bitmap, the glyph table and a
+pcd8544_font_desc_t named after -n. The glyph table covers the first to the
+last character, or, when that takes less memory, sorted ranges of code
+points: Latin-1, Cyrillic or Vietnamese subsets only take the glyphs they
+have and a range for every run of them.
+"""
+
+import argparse
+import re
+import sys
+
+HEIGHT_MAX = 32
+OFFSET_MAX = 0xFFFF
+CODE_MAX = 0xFFFF
+
+# Characters named in the comments of the glyph table, a backslash would
+# continue the comment onto the next line
+NAMES = {0x20: "space", 0x5C: "backslash"}
+
+# Bytes of a glyph table entry and of a code point range
+GLYPH_SIZE = 4
+RANGE_SIZE = 6
+
+
+class Glyph:
+    def __init__(self, code, rows, advance=None):
+        self.code = code
+        self.rows = rows  # Strings of '#' and '.', all of the same length
+        self.advance = advance  # None: width + spacing
+
+    @property
+    def width(self):
+        return len(self.rows[0]) if self.rows else 0
+
+
+def parse_code(text):
+    text = text.strip()
+    if len(text) == 3 and text[0] == text[2] == "'":
+        code = ord(text[1])
+    elif text.upper().startswith("U+"):
+        code = int(text[2:], 16)
+    else:
+        code = int(text, 0)
+    if not 0 <= code <= CODE_MAX:
+        raise ValueError("char %s: code points go up to U+%04X"
+                         % (text, CODE_MAX))
+    return code
+
+
+def strip_comment(line):
+    line = line.strip()
+    # Glyph rows may start with '#' as well, they are all '#' and '.'
+    if re.match(r"^[#.]+$", line):
+        return line
+    return re.sub(r"(^|\s)#.*$", "", line).strip()
+
+
+def read_text(data):
+    height = spacing = None
+    glyphs = []
+    lines = [strip_comment(line) for line in data.splitlines()]
+    i = 0
+    while i < len(lines):
+        fields = lines[i].split(None, 1)
+        i += 1
+        if not fields:
+            continue
+        if fields[0] == "height":
+            height = int(fields[1])
+        elif fields[0] == "spacing":
+            spacing = int(fields[1])
+        elif fields[0] == "char":
+            if height is None:
+                raise ValueError("char before height")
+            rows = lines[i:i + height]
+            i += height
+            if len(rows) < height or not all(re.match(r"^[#.]+$", r)
+                                             for r in rows):
+                raise ValueError("char %s: expected %d rows of '#' and '.'"
+                                 % (fields[1], height))
+            if len(set(map(len, rows))) != 1:
+                raise ValueError("char %s: rows differ in width" % fields[1])
+            glyphs.append(Glyph(parse_code(fields[1]), rows))
+        else:
+            raise ValueError("unknown line '%s'" % lines[i - 1])
+    if height is None:
+        raise ValueError("no height")
+    return height, spacing, glyphs
+
+
+def read_bdf(data):
+    ascent = descent = None
+    glyphs = []
+    code = advance = bbx = None
+    bitmap = None
+    for line in data.splitlines():
+        fields = line.split()
+        if not fields:
+            continue
+        key = fields[0]
+        if key == "FONT_ASCENT":
+            ascent = int(fields[1])
+        elif key == "FONT_DESCENT":
+            descent = int(fields[1])
+        elif key == "STARTCHAR":
+            code = advance = bbx = None
+        elif key == "ENCODING":
+            code = int(fields[1])
+        elif key == "DWIDTH":
+            advance = int(fields[1])
+        elif key == "BBX":
+            bbx = [int(f) for f in fields[1:5]]
+        elif key == "BITMAP":
+            bitmap = []
+        elif key == "ENDCHAR":
+            if 0 <= code <= CODE_MAX:
+                glyphs.append((code, advance, bbx, bitmap))
+            bitmap = None
+        elif bitmap is not None:
+            bitmap.append(int(key, 16) << (4 * (8 - len(key))))
+    if ascent is None or descent is None:
+        raise ValueError("no FONT_ASCENT / FONT_DESCENT")
+
+    height = ascent + descent
+    result = []
+    for code, advance, (w, h, xoff, yoff), bitmap in glyphs:
+        # Glyphs sit on the baseline, ascent rows down from the top
+        left = max(xoff, 0)
+        top = ascent - (yoff + h)
+        rows = [["."] * (left + w) for _ in range(height)]
+        for r, bits in enumerate(bitmap):
+            for c in range(w):
+                if bits >> (31 - c) & 1 and 0 <= top + r < height:
+                    rows[top + r][left + c] = "#"
+        result.append(Glyph(code, ["".join(r) for r in rows], advance))
+    return height, None, result
+
+
+def trim(glyph, space):
+    """Cut the blank columns off both sides of a proportional glyph."""
+    cols = [c for c in range(glyph.width)
+            if any(r[c] == "#" for r in glyph.rows)]
+    if not cols:
+        glyph.rows = [""] * len(glyph.rows)
+        glyph.advance = space
+        return
+    glyph.rows = [r[cols[0]:cols[-1] + 1] for r in glyph.rows]
+
+
+def pack(height, spacing, glyphs):
+    bits = []
+    table = {}
+    for glyph in glyphs:
+        width = glyph.width
+        # Blank glyphs only move the cursor
+        if not any("#" in r for r in glyph.rows):
+            width = 0
+        advance = glyph.advance
+        if advance is None:
+            advance = glyph.width + spacing
+        table[glyph.code] = (len(bits), width, advance)
+        for c in range(width):
+            bits.extend(int(glyph.rows[r][c] == "#") for r in range(height))
+
+    if len(bits) > OFFSET_MAX:
+        raise ValueError("%d bits of glyphs, at most %d fit"
+                         % (len(bits), OFFSET_MAX))
+    bitmap = bytearray((len(bits) + 7) // 8)
+    for i, bit in enumerate(bits):
+        bitmap[i // 8] |= bit << (i % 8)
+    return bitmap, table
+
+
+def unpack(bitmap, height, offset, width):
+    """Reference reader, used to check every packed glyph."""
+    rows = [["."] * width for _ in range(height)]
+    for c in range(width):
+        for r in range(height):
+            bit = offset + c * height + r
+            if bitmap[bit // 8] >> (bit % 8) & 1:
+                rows[r][c] = "#"
+    return ["".join(r) for r in rows]
+
+
+def layout(table):
+    """Order the glyph table, as one run of first ~ last or, when that takes
+    more memory, as sorted ranges of code points. Returns the code of every
+    entry, None for a blank one, and the ranges as (first, last, index)."""
+    codes = sorted(table)
+    runs = []
+    for code in codes:
+        # A short gap costs less as blank entries than as a new range
+        if runs and (code - runs[-1][1] - 1) * GLYPH_SIZE < RANGE_SIZE:
+            runs[-1][1] = code
+        else:
+            runs.append([code, code])
+
+    dense = codes[-1] - codes[0] + 1
+    ranged = sum(last - first + 1 for first, last in runs)
+    if codes[-1] <= 0xFF and dense * GLYPH_SIZE <= \
+            ranged * GLYPH_SIZE + len(runs) * RANGE_SIZE:
+        return [c if c in table else None
+                for c in range(codes[0], codes[-1] + 1)], None
+
+    entries = []
+    ranges = []
+    for first, last in runs:
+        ranges.append((first, last, len(entries)))
+        entries.extend(c if c in table else None
+                       for c in range(first, last + 1))
+    return entries, ranges
+
+
+def describe(code):
+    if 32 <= code < 127:
+        return "%02x %s" % (code, NAMES.get(code, chr(code)))
+    return "U+%04X" % code
+
+
+def c_source(name, height, bitmap, table):
+    entries, ranges = layout(table)
+    lines = ["static const uint8_t %s_bitmap[%d] = {" % (name, len(bitmap))]
+    for i in range(0, len(bitmap), 12):
+        lines.append("    " + ", ".join("0x%02X" % b
+                                        for b in bitmap[i:i + 12]) + ",")
+    lines += ["};", ""]
+
+    lines.append("static const pcd8544_glyph_t %s_glyphs[%d] = {"
+                 % (name, len(entries)))
+    for i, code in enumerate(entries):
+        offset, width, advance = table.get(code, (0, 0, 0))
+        if code is None:
+            code = entries[i - 1] + 1
+            entries[i] = code
+        lines.append("    {%5d, %2d, %2d},  // %s"
+                     % (offset, width, advance, describe(code)))
+    lines += ["};", ""]
+
+    if ranges:
+        lines.append("static const pcd8544_glyph_range_t %s_ranges[%d] = {"
+                     % (name, len(ranges)))
+        lines += ["    {0x%04X, 0x%04X, %3d}," % r for r in ranges]
+        lines += ["};", ""]
+
+    lines += ["static const pcd8544_font_desc_t %s = {" % name,
+              "    .bitmap    = %s_bitmap," % name,
+              "    .glyphs    = %s_glyphs," % name]
+    if ranges:
+        lines += ["    .ranges    = %s_ranges," % name,
+                  "    .range_num = %d," % len(ranges)]
+    else:
+        lines += ["    .first     = %d," % entries[0],
+                  "    .last      = %d," % entries[-1]]
+    lines += ["    .height    = %d," % height,
+              "    .stride    = %d," % height,
+              "};"]
+    return "\n".join(lines), len(bitmap) + GLYPH_SIZE * len(entries) + \
+        RANGE_SIZE * len(ranges or [])
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Convert bitmap fonts for pcd8544_putc_font().")
+    parser.add_argument("font", help="BDF or text font")
+    parser.add_argument("-n", "--name", default="font",
+                        help="name of the C font descriptor")
+    parser.add_argument("-o", "--output", help="header file, default stdout")
+    parser.add_argument("--chars", help="characters to keep, default all")
+    parser.add_argument("--trim", action="store_true",
+                        help="cut blank columns off the sides of glyphs")
+    parser.add_argument("--spacing", type=int,
+                        help="blank columns after every glyph, default 1")
+    parser.add_argument("--space", type=int, default=3,
+                        help="advance of blank glyphs with --trim")
+    args = parser.parse_args()
+
+    if not re.match(r"^[A-Za-z_]\w*$", args.name):
+        parser.error("name must be a C identifier")
+
+    try:
+        with open(args.font, encoding="utf-8", errors="replace") as f:
+            data = f.read()
+        if data.startswith("STARTFONT"):
+            height, spacing, glyphs = read_bdf(data)
+        else:
+            height, spacing, glyphs = read_text(data)
+        if not 1 <= height <= HEIGHT_MAX:
+            raise ValueError("height must be 1 ~ %d" % HEIGHT_MAX)
+    except (OSError, ValueError) as e:
+        sys.exit("%s: %s" % (args.font, e))
+
+    if args.spacing is not None:
+        spacing = args.spacing
+    if spacing is None:
+        spacing = 1
+    if args.chars:
+        glyphs = [g for g in glyphs if chr(g.code) in args.chars]
+    if not glyphs:
+        sys.exit("%s: no glyphs" % args.font)
+    if args.trim:
+        for glyph in glyphs:
+            trim(glyph, args.space)
+
+    try:
+        bitmap, table = pack(height, spacing, glyphs)
+    except ValueError as e:
+        sys.exit("%s: %s" % (args.font, e))
+    for glyph in glyphs:
+        offset, width, _ = table[glyph.code]
+        if width:
+            assert unpack(bitmap, height, offset, width) == glyph.rows
+
+    source, size = c_source(args.name, height, bitmap, table)
+    guard = "__%s_H__" % args.name.upper()
+    header = "\n\n".join(
+        ["// Generated by pcd8544_font.py, %d glyphs in %d bytes" %
+         (len(glyphs), size),
+         "#ifndef %s\n#define %s\n\n#include \"pcd8544.h\"" % (guard, guard),
+         source,
+         "#endif /* %s */\n" % guard])
+
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(header)
+    else:
+        sys.stdout.write(header)
+
+
+if __name__ == "__main__":
+    main()